@@ -0,0 +1,179 @@
+// CUDA backend for gpu_sum.h. Every sum is one block-reduce kernel: each thread accumulates a
+// grid-stride slice of the input in the accumulator type, warps reduce with shuffles, and each
+// block writes one partial sum. The host adds the gpuBlocks partials in block order, so a given
+// input always gives the same result.
+
+#include "gpu_sum.h"
+
+#include <cuda_runtime.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int gpuThreads = 256;
+constexpr int gpuBlocks = 1024;
+
+void check(cudaError_t status, const char* what) {
+    if (status != cudaSuccess)
+        throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(status));
+}
+
+template<class Acc>
+__device__ Acc warp_sum(Acc value) {
+    for (int offset = warpSize / 2; offset > 0; offset /= 2)
+        value += __shfl_down_sync(0xffffffffu, value, offset);
+    return value;
+}
+
+template<class T, class Acc>
+__global__ void block_reduce(const T* data, size_t count, Acc* partials) {
+    __shared__ Acc warpSums[gpuThreads / 32];
+
+    Acc sum = 0;
+    for (size_t i = blockIdx.x * size_t(blockDim.x) + threadIdx.x; i < count; i += size_t(gridDim.x) * blockDim.x)
+        sum += static_cast<Acc>(data[i]);
+
+    sum = warp_sum(sum);
+    int lane = threadIdx.x % warpSize, warp = threadIdx.x / warpSize;
+    if (lane == 0)
+        warpSums[warp] = sum;
+    __syncthreads();
+
+    if (warp == 0) {
+        sum = lane < int(blockDim.x) / warpSize ? warpSums[lane] : Acc(0);
+        sum = warp_sum(sum);
+        if (lane == 0)
+            partials[blockIdx.x] = sum;
+    }
+}
+
+// Device buffers and events, kept for the life of the process and grown on demand
+class GpuContext {
+public:
+    GpuContext() {
+        int devices = 0;
+        if (cudaGetDeviceCount(&devices) != cudaSuccess || devices == 0)
+            return;
+        cudaDeviceProp properties{};
+        check(cudaGetDeviceProperties(&properties, 0), "cudaGetDeviceProperties");
+        name = properties.name;
+        check(cudaEventCreate(&start), "cudaEventCreate");
+        check(cudaEventCreate(&copied), "cudaEventCreate");
+        check(cudaEventCreate(&reduced), "cudaEventCreate");
+        check(cudaMalloc(&partials, gpuBlocks * sizeof(unsigned long long)), "cudaMalloc");
+    }
+
+    ~GpuContext() {
+        if (name.empty())
+            return;
+        cudaFree(input);
+        cudaFree(partials);
+        cudaEventDestroy(start);
+        cudaEventDestroy(copied);
+        cudaEventDestroy(reduced);
+    }
+
+    template<class T, class Acc>
+    Acc sum(std::span<const T> data, GpuInput mode, GpuSumTiming& timing) {
+        if (name.empty())
+            throw std::runtime_error("no CUDA device");
+        size_t bytes = data.size_bytes();
+        if (bytes > capacity) {
+            check(cudaFree(input), "cudaFree");
+            input = nullptr;
+            capacity = 0;
+            residentHost = nullptr;
+            check(cudaMalloc(&input, bytes), "cudaMalloc of the input");
+            capacity = bytes;
+        }
+        bool upload = mode == GpuInput::PinnedHost || residentHost != data.data() || residentBytes != bytes;
+
+        check(cudaEventRecord(start), "cudaEventRecord");
+        if (upload && bytes > 0)
+            check(cudaMemcpyAsync(input, data.data(), bytes, cudaMemcpyHostToDevice), "cudaMemcpyAsync");
+        check(cudaEventRecord(copied), "cudaEventRecord");
+        block_reduce<T, Acc><<<gpuBlocks, gpuThreads>>>(static_cast<const T*>(input), data.size(),
+                                                         static_cast<Acc*>(partials));
+        check(cudaGetLastError(), "block_reduce launch");
+        std::vector<Acc> blockSums(gpuBlocks);
+        check(cudaMemcpyAsync(blockSums.data(), partials, gpuBlocks * sizeof(Acc), cudaMemcpyDeviceToHost),
+              "cudaMemcpyAsync");
+        check(cudaEventRecord(reduced), "cudaEventRecord");
+        check(cudaEventSynchronize(reduced), "cudaEventSynchronize");
+
+        float transferMs = 0, kernelMs = 0;
+        check(cudaEventElapsedTime(&transferMs, start, copied), "cudaEventElapsedTime");
+        check(cudaEventElapsedTime(&kernelMs, copied, reduced), "cudaEventElapsedTime");
+        timing.transferMs = upload ? transferMs : 0.0;
+        timing.kernelMs = kernelMs;
+
+        // A pinned-host copy leaves the data on the device too
+        residentHost = data.data();
+        residentBytes = bytes;
+
+        Acc total = 0;
+        for (Acc blockSum : blockSums)
+            total += blockSum;
+        return total;
+    }
+
+    std::string name;
+
+private:
+    void* input = nullptr;
+    size_t capacity = 0;
+    void* partials = nullptr;
+    const void* residentHost = nullptr;
+    size_t residentBytes = 0;
+    cudaEvent_t start{}, copied{}, reduced{};
+};
+
+GpuContext& gpu_context() {
+    static GpuContext context;
+    return context;
+}
+
+}  // namespace
+
+std::string gpu_device_name() {
+    return gpu_context().name;
+}
+
+void gpu_pin_host(const void* data, size_t bytes) {
+    // Read-only registration also works for read-only file mappings
+    if (cudaHostRegister(const_cast<void*>(data), bytes, cudaHostRegisterReadOnly) != cudaSuccess) {
+        cudaGetLastError();
+        check(cudaHostRegister(const_cast<void*>(data), bytes, cudaHostRegisterDefault), "cudaHostRegister");
+    }
+}
+
+void gpu_unpin_host(const void* data) {
+    check(cudaHostUnregister(const_cast<void*>(data)), "cudaHostUnregister");
+}
+
+long long gpu_sum(std::span<const int16_t> data, GpuInput input, GpuSumTiming& timing) {
+    return gpu_context().sum<int16_t, long long>(data, input, timing);
+}
+
+long long gpu_sum(std::span<const int32_t> data, GpuInput input, GpuSumTiming& timing) {
+    return gpu_context().sum<int32_t, long long>(data, input, timing);
+}
+
+unsigned long long gpu_sum(std::span<const uint32_t> data, GpuInput input, GpuSumTiming& timing) {
+    return gpu_context().sum<uint32_t, unsigned long long>(data, input, timing);
+}
+
+long long gpu_sum(std::span<const int64_t> data, GpuInput input, GpuSumTiming& timing) {
+    return gpu_context().sum<int64_t, long long>(data, input, timing);
+}
+
+double gpu_sum(std::span<const float> data, GpuInput input, GpuSumTiming& timing) {
+    return gpu_context().sum<float, double>(data, input, timing);
+}
+
+double gpu_sum(std::span<const double> data, GpuInput input, GpuSumTiming& timing) {
+    return gpu_context().sum<double, double>(data, input, timing);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// Optional CUDA summation backend, compiled from gpu_sum.cu when CMake is configured with
+// -DPARALLEL_SUM_CUDA=ON. Without it, main.cpp defines these functions as a CPU fallback:
+// gpu_device_name() is empty and the sums throw.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// PinnedHost:     the input is in host memory pinned with gpu_pin_host and is copied to the
+//                 device on every call
+// DeviceResident: the input stays on the device between calls; it is uploaded on the first call
+//                 for a buffer, and only that call reports a transfer
+enum class GpuInput { PinnedHost, DeviceResident };
+
+struct GpuSumTiming {
+    double transferMs = 0;   // host to device copy
+    double kernelMs = 0;     // block reduction, including reading back the per-block partial sums
+};
+
+// Name of the CUDA device in use, or empty when there is none
+std::string gpu_device_name();
+
+// Page-locks a host buffer, so that copies from it run at full bus bandwidth
+void gpu_pin_host(const void* data, size_t bytes);
+void gpu_unpin_host(const void* data);
+
+long long gpu_sum(std::span<const int16_t> data, GpuInput input, GpuSumTiming& timing);
+long long gpu_sum(std::span<const int32_t> data, GpuInput input, GpuSumTiming& timing);
+unsigned long long gpu_sum(std::span<const uint32_t> data, GpuInput input, GpuSumTiming& timing);
+long long gpu_sum(std::span<const int64_t> data, GpuInput input, GpuSumTiming& timing);
+double gpu_sum(std::span<const float> data, GpuInput input, GpuSumTiming& timing);
+double gpu_sum(std::span<const double> data, GpuInput input, GpuSumTiming& timing);
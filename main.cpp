@@ -4,14 +4,81 @@
 #include <numeric>
 #include <thread>
 #include <atomic>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
 #include <cstddef>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <map>
+#include <unordered_map>
+#include <tuple>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <array>
 #include "kaizen.h"
+#include "gpu_sum.h"
 #include <future>
+#include <optional>
+#include <new>
+#include <cstdlib>
+#include <utility>
+#include <coroutine>
+#include <stop_token>
+#include <exception>
+#include <bit>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#else
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
 
 template<typename Func>
 double measure_time(Func&& func) {
@@ -22,374 +89,6836 @@ double measure_time(Func&& func) {
     return timer.duration<zen::timer::usec>().count() / 1000.0;
 }
 
+template<class Acc>
 void print_result(const std::string& method, const std::string& memoryOrder,
-                  long long sum, double timeMs) {
-    std::cout << std::setw(20) << method
+                  Acc sum, double scalarMs, double simdMs, size_t bytes) {
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(20) << method
               << std::setw(20) << memoryOrder
               << std::setw(20) << sum
-              << std::fixed << std::setprecision(2) << std::setw(20) << timeMs << "\n";
+              << std::setw(15) << scalarMs
+              << std::setw(15) << simdMs
+              << std::setw(15) << scalarMs / simdMs
+              << std::setw(15) << bytes / (simdMs * 1e6) << "\n";
 }
 
-void atomic_sum(const std::vector<int>& data, std::atomic<long long>& total,
-                std::memory_order order, unsigned int numThreads, 
-                double* creation_time = nullptr, double* join_time = nullptr) {
-    std::vector<std::thread> threads;
-    size_t chunk = data.size() / numThreads;
+// Repeated timing: warmupRuns untimed runs, then timedRuns timed ones. reset() runs before every
+// run, outside the timed region, to clear whatever the previous run accumulated. Tukey's fences
+// (1.5 interquartile ranges) flag outliers; they are counted but kept in the statistics.
+inline int warmupRuns = 1;
+inline int timedRuns = 5;
 
-    auto worker = [&data, &total, order](size_t start, size_t end) {
-        long long localSum = 0;
-        for (size_t i = start; i < end; ++i)
-            localSum += data[i];
-        total.fetch_add(localSum, order);
-    };
+struct TimingStats {
+    size_t runs = 0;
+    size_t outliers = 0;
+    double min = 0, median = 0, p90 = 0, p99 = 0, mean = 0;
+    double ci95 = 0;            // half-width of the 95% confidence interval of the mean
+    std::vector<double> samples;  // in run order
+};
 
-    // Measure thread creation time
-    auto creation_timer = zen::timer();
-    if (creation_time)
-        creation_timer.start();
-    
-    for (unsigned int i = 0; i < numThreads; ++i) {
-        size_t start = i * chunk;
-        size_t end = (i == numThreads - 1) ? data.size() : start + chunk;
-        threads.emplace_back(worker, start, end);
+// Two-sided 95% Student t quantile for the given degrees of freedom
+double t_quantile_95(size_t df) {
+    static const double table[] = {12.71, 4.30, 3.18, 2.78, 2.57, 2.45, 2.36, 2.31, 2.26, 2.23,
+                                   2.20, 2.18, 2.16, 2.14, 2.13, 2.12, 2.11, 2.10, 2.09, 2.09,
+                                   2.08, 2.07, 2.07, 2.06, 2.06, 2.06, 2.05, 2.05, 2.05, 2.04};
+    if (df == 0)
+        return 0;
+    return df <= std::size(table) ? table[df - 1] : 1.96;
+}
+
+// Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+template<class Func, class Reset>
+TimingStats measure_stats(Func&& func, Reset&& reset) {
+    for (int w = 0; w < warmupRuns; ++w) {
+        reset();
+        func();
     }
-    
-    if (creation_time) {
-        creation_timer.stop();
-        *creation_time = creation_timer.duration<zen::timer::usec>().count() / 1000.0;
+    TimingStats stats;
+    for (int r = 0; r < std::max(timedRuns, 1); ++r) {
+        reset();
+        stats.samples.push_back(measure_time(func));
     }
+    std::vector<double> samples = stats.samples;
+    std::sort(samples.begin(), samples.end());
 
-    // Measure join time
-    auto join_timer = zen::timer();
-    if (join_time)
-        join_timer.start();
-    
-    for (auto& t : threads)
-        t.join();
-        
-    if (join_time) {
-        join_timer.stop();
-        *join_time = join_timer.duration<zen::timer::usec>().count() / 1000.0;
+    stats.runs = samples.size();
+    stats.min = samples.front();
+    stats.median = percentile(samples, 50);
+    stats.p90 = percentile(samples, 90);
+    stats.p99 = percentile(samples, 99);
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    if (samples.size() > 1) {
+        double squares = 0;
+        for (double sample : samples)
+            squares += (sample - stats.mean) * (sample - stats.mean);
+        double stddev = std::sqrt(squares / (samples.size() - 1));
+        stats.ci95 = t_quantile_95(samples.size() - 1) * stddev / std::sqrt(double(samples.size()));
     }
+    double q1 = percentile(samples, 25), q3 = percentile(samples, 75);
+    double fence = 1.5 * (q3 - q1);
+    stats.outliers = std::count_if(samples.begin(), samples.end(), [&](double sample) {
+        return sample < q1 - fence || sample > q3 + fence;
+    });
+    return stats;
 }
 
-void reduce_sum(const std::vector<int>& data, std::vector<long long>& partialSums,
-                unsigned int numThreads, double* creation_time = nullptr, double* join_time = nullptr) {
-    std::vector<std::thread> threads;
-    size_t chunk = data.size() / numThreads;
+template<class Func>
+TimingStats measure_stats(Func&& func) {
+    return measure_stats(std::forward<Func>(func), []() {});
+}
 
-    auto worker = [&data, &partialSums](unsigned int tid, size_t start, size_t end) {
-        for (size_t i = start; i < end; ++i)
-            partialSums[tid] += data[i];
-    };
+// Element and Accumulator Types
+//
+// Every summation routine is templated over the element type T and the accumulator type Acc.
+// By default the accumulator is picked per element type at compile time: integers widen to
+// 64 bits of the same signedness, floating-point values accumulate in double.
+template<class T>
+struct accumulator_for {
+    static_assert(std::is_arithmetic_v<T>, "summation needs an arithmetic element type");
+    using type = std::conditional_t<std::is_floating_point_v<T>, double,
+                 std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>>;
+};
 
-    // Measure thread creation time
-    auto creation_timer = zen::timer();
-    if (creation_time) creation_timer.start();
-    
-    for (unsigned int i = 0; i < numThreads; ++i) {
-        size_t start = i * chunk;
-        size_t end = (i == numThreads - 1) ? data.size() : start + chunk;
-        threads.emplace_back(worker, i, start, end);
-    }
-    
-    if (creation_time) {
-        creation_timer.stop();
-        *creation_time = creation_timer.duration<zen::timer::usec>().count() / 1000.0;
+template<class T>
+using accumulator_t = typename accumulator_for<T>::type;
+
+// Name of an element type as accepted by --type
+template<class T>
+const char* element_type_name() {
+    if constexpr (std::is_same_v<T, int16_t>)
+        return "int16";
+    else if constexpr (std::is_same_v<T, int32_t>)
+        return "int32";
+    else if constexpr (std::is_same_v<T, uint32_t>)
+        return "uint32";
+    else if constexpr (std::is_same_v<T, int64_t>)
+        return "int64";
+    else if constexpr (std::is_same_v<T, float>)
+        return "float";
+    else if constexpr (std::is_same_v<T, double>)
+        return "double";
+    else
+        return "other";
+}
+
+// Adds value to an atomic accumulator; floating-point atomics fall back to a CAS loop
+template<class Acc>
+void atomic_add(std::atomic<Acc>& total, Acc value, std::memory_order order) {
+    if constexpr (std::is_integral_v<Acc>) {
+        total.fetch_add(value, order);
+    } else {
+        Acc expected = total.load(std::memory_order_relaxed);
+        while (!total.compare_exchange_weak(expected, expected + value, order, std::memory_order_relaxed)) {}
     }
+}
 
-    // Measure join time
-    auto join_timer = zen::timer();
-    if (join_time) join_timer.start();
-    
-    for (auto& t : threads)
-        t.join();
-        
-    if (join_time) {
-        join_timer.stop();
-        *join_time = join_timer.duration<zen::timer::usec>().count() / 1000.0;
+// SIMD Summation Kernels
+//
+// Every kernel sums count elements starting at data into an accumulator. The int32 vector
+// kernels widen int32 lanes to int64 and keep four independent accumulators to hide the add
+// latency. Other element types use the portable unrolled kernel, whose independent accumulators
+// the compiler turns into vector code for the target.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET(isa)
+#define SIMD_INLINE __forceinline
+#else
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#define SIMD_INLINE inline __attribute__((always_inline))
+#endif
+
+// Scalar:   plain loop
+// Simd:     vectorized kernel (runtime-dispatched for int32, unrolled otherwise)
+// Kahan, Neumaier, Pairwise: compensated and blocked-tree kernels for floating-point accumulators;
+//           with an integer accumulator the sum is exact anyway and they fall back to Simd
+enum class SumKernel { Scalar, Simd, Kahan, Neumaier, Pairwise };
+
+const char* to_string(SumKernel kernel) {
+    switch (kernel) {
+    case SumKernel::Scalar:   return "scalar";
+    case SumKernel::Simd:     return "simd";
+    case SumKernel::Kahan:    return "kahan";
+    case SumKernel::Neumaier: return "neumaier";
+    case SumKernel::Pairwise: return "pairwise";
     }
+    return "unknown";
 }
 
-void single_thread_sum(const std::vector<int>& data, long long& result) {
-    result = 0;
-    for (int value : data)
-        result += value;
+template<class T, class Acc>
+using SumKernelFn = Acc (*)(const T* data, size_t count);
+
+template<class T, class Acc = accumulator_t<T>>
+Acc scalar_sum_kernel(const T* data, size_t count) {
+    Acc sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += data[i];
+    return sum;
 }
 
-// Thread Pool Implementation
-class ThreadPool {
-public:
-    ThreadPool(size_t numThreads) : stop(false) {
-        for (size_t i = 0; i < numThreads; ++i) {
-            workers.emplace_back([this] {
-                while (true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(this->queueMutex);
-                        this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
-                        if (this->stop && this->tasks.empty())
-                            return;
-                        task = std::move(this->tasks.front());
-                        this->tasks.pop();
-                    }
-                    task();
-                }
-            });
-        }
-    }
+template<class T, class Acc = accumulator_t<T>>
+Acc unrolled_sum_kernel(const T* data, size_t count) {
+    constexpr size_t lanes = 8;
+    Acc acc[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+        for (size_t k = 0; k < lanes; ++k)
+            acc[k] += static_cast<Acc>(data[i + k]);
+    Acc sum = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    return sum + scalar_sum_kernel<T, Acc>(data + i, count - i);
+}
 
-    template<class F>
-    void enqueue(F&& f) {
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            if (stop)
-                throw std::runtime_error("enqueue on stopped ThreadPool");
-            tasks.emplace(std::forward<F>(f));
-        }
-        condition.notify_one();
+// Compensated and Pairwise Floating-Point Kernels
+//
+// Like the unrolled kernel they keep eight independent lanes, so the compiler can vectorize them.
+// They rely on strict IEEE evaluation and must not be built with -ffast-math.
+
+// Folds one value into a Neumaier (sum, compensation) pair; branch-free so lanes vectorize
+template<class Acc>
+inline void neumaier_add(Acc& sum, Acc& comp, Acc x) {
+    Acc t = sum + x;
+    bool sumIsBigger = std::abs(sum) >= std::abs(x);
+    Acc big = sumIsBigger ? sum : x;
+    Acc small = sumIsBigger ? x : sum;
+    comp += (big - t) + small;
+    sum = t;
+}
+
+// Combines per-lane (sum, compensation) pairs without losing the compensation
+template<class Acc, size_t lanes>
+Acc neumaier_combine(const Acc (&sums)[lanes], const Acc (&comps)[lanes]) {
+    Acc sum = 0, comp = 0;
+    for (size_t k = 0; k < lanes; ++k) {
+        neumaier_add(sum, comp, sums[k]);
+        comp += comps[k];
     }
+    return sum + comp;
+}
 
-    ~ThreadPool() {
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            stop = true;
+template<class T, class Acc = accumulator_t<T>>
+Acc kahan_sum_kernel(const T* data, size_t count) {
+    constexpr size_t lanes = 8;
+    Acc sums[lanes] = {}, comps[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        for (size_t k = 0; k < lanes; ++k) {
+            Acc y = static_cast<Acc>(data[i + k]) - comps[k];
+            Acc t = sums[k] + y;
+            comps[k] = (t - sums[k]) - y;
+            sums[k] = t;
         }
-        condition.notify_all();
-        for (std::thread &worker : workers)
-            worker.join();
     }
+    // Kahan keeps the negated error, Neumaier the error itself
+    for (size_t k = 0; k < lanes; ++k)
+        comps[k] = -comps[k];
+    for (; i < count; ++i)
+        neumaier_add(sums[0], comps[0], static_cast<Acc>(data[i]));
+    return neumaier_combine(sums, comps);
+}
 
-private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queueMutex;
-    std::condition_variable condition;
-    bool stop;
-};
+template<class T, class Acc = accumulator_t<T>>
+Acc neumaier_sum_kernel(const T* data, size_t count) {
+    constexpr size_t lanes = 8;
+    Acc sums[lanes] = {}, comps[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+        for (size_t k = 0; k < lanes; ++k)
+            neumaier_add(sums[k], comps[k], static_cast<Acc>(data[i + k]));
+    for (; i < count; ++i)
+        neumaier_add(sums[0], comps[0], static_cast<Acc>(data[i]));
+    return neumaier_combine(sums, comps);
+}
 
-void threadpool_sum(const std::vector<int>& data, std::atomic<long long>& total,
-                   unsigned int numThreads) {
-    ThreadPool pool(numThreads);
-    size_t chunk = data.size() / numThreads;
-    std::atomic<int> completed_tasks(0);
-    std::mutex completion_mutex;
-    std::condition_variable completion_cv;
+// Blocks of up to pairwiseBlockSize elements are summed by the unrolled kernel and the block
+// sums combined in a balanced binary tree, so the error grows with log(n) instead of n
+constexpr size_t pairwiseBlockSize = 128;
 
-    for (unsigned int i = 0; i < numThreads; ++i) {
-        size_t start = i * chunk;
-        size_t end = (i == numThreads - 1) ? data.size() : start + chunk;
+template<class T, class Acc = accumulator_t<T>>
+Acc pairwise_sum_kernel(const T* data, size_t count) {
+    if (count <= pairwiseBlockSize)
+        return unrolled_sum_kernel<T, Acc>(data, count);
+    size_t half = (count / 2 + pairwiseBlockSize - 1) / pairwiseBlockSize * pairwiseBlockSize;
+    return pairwise_sum_kernel<T, Acc>(data, half) + pairwise_sum_kernel<T, Acc>(data + half, count - half);
+}
 
-        pool.enqueue([&data, &total, start, end, &completed_tasks, &completion_mutex, &completion_cv, numThreads]() {
-            long long localSum = 0;
-            for (size_t j = start; j < end; ++j) {
-                localSum += data[j];
-            }
-            total.fetch_add(localSum, std::memory_order_relaxed);
+#if defined(SIMD_X86)
+SIMD_TARGET("sse4.1")
+long long sse4_sum_kernel(const int* data, size_t count) {
+    __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+    __m128i acc2 = _mm_setzero_si128(), acc3 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4));
+        acc0 = _mm_add_epi64(acc0, _mm_cvtepi32_epi64(a));
+        acc1 = _mm_add_epi64(acc1, _mm_cvtepi32_epi64(_mm_srli_si128(a, 8)));
+        acc2 = _mm_add_epi64(acc2, _mm_cvtepi32_epi64(b));
+        acc3 = _mm_add_epi64(acc3, _mm_cvtepi32_epi64(_mm_srli_si128(b, 8)));
+    }
+    __m128i acc = _mm_add_epi64(_mm_add_epi64(acc0, acc1), _mm_add_epi64(acc2, acc3));
+    alignas(16) long long lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + scalar_sum_kernel<int, long long>(data + i, count - i);
+}
 
-            // Signal completion
-            {
-                std::lock_guard<std::mutex> lock(completion_mutex);
-                completed_tasks.fetch_add(1);
-            }
-            completion_cv.notify_one();
-        });
+SIMD_TARGET("avx2")
+long long avx2_sum_kernel(const int* data, size_t count) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(data + i);
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128(p)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128(p + 1)));
+        acc2 = _mm256_add_epi64(acc2, _mm256_cvtepi32_epi64(_mm_loadu_si128(p + 2)));
+        acc3 = _mm256_add_epi64(acc3, _mm256_cvtepi32_epi64(_mm_loadu_si128(p + 3)));
     }
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_sum_kernel<int, long long>(data + i, count - i);
+}
 
-    // Wait for all tasks to complete
-    std::unique_lock<std::mutex> lock(completion_mutex);
-    completion_cv.wait(lock, [&completed_tasks, numThreads]() {
-        return completed_tasks.load() >= static_cast<int>(numThreads);
-    });
+// The zero-masked widening and the lane store below do the work of _mm512_cvtepi32_epi64 and
+// _mm512_reduce_add_epi64, whose GCC 12 versions read an uninitialized vector and trip
+// -Wuninitialized
+SIMD_TARGET("avx512f")
+long long avx512_sum_kernel(const int* data, size_t count) {
+    __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+    __m512i acc2 = _mm512_setzero_si512(), acc3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i* p = reinterpret_cast<const __m256i*>(data + i);
+        acc0 = _mm512_add_epi64(acc0, _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(p)));
+        acc1 = _mm512_add_epi64(acc1, _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(p + 1)));
+        acc2 = _mm512_add_epi64(acc2, _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(p + 2)));
+        acc3 = _mm512_add_epi64(acc3, _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(p + 3)));
+    }
+    __m512i acc = _mm512_add_epi64(_mm512_add_epi64(acc0, acc1), _mm512_add_epi64(acc2, acc3));
+    alignas(64) long long lanes[8];
+    _mm512_store_si512(lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]
+           + scalar_sum_kernel<int, long long>(data + i, count - i);
+}
+#elif defined(SIMD_NEON)
+long long neon_sum_kernel(const int* data, size_t count) {
+    int64x2_t acc0 = vdupq_n_s64(0), acc1 = vdupq_n_s64(0);
+    int64x2_t acc2 = vdupq_n_s64(0), acc3 = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = vpadalq_s32(acc0, vld1q_s32(data + i));
+        acc1 = vpadalq_s32(acc1, vld1q_s32(data + i + 4));
+        acc2 = vpadalq_s32(acc2, vld1q_s32(data + i + 8));
+        acc3 = vpadalq_s32(acc3, vld1q_s32(data + i + 12));
+    }
+    int64x2_t acc = vaddq_s64(vaddq_s64(acc0, acc1), vaddq_s64(acc2, acc3));
+    return vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1) + scalar_sum_kernel<int, long long>(data + i, count - i);
 }
+#endif
 
-// Task-based sum using std::async
-long long async_sum(const std::vector<int>& data, size_t start, size_t end, unsigned int min_per_task = 100000) {
-    size_t length = end - start;
-    if (length <= min_per_task) {
-        long long sum = 0;
-        for (size_t i = start; i < end; ++i)
-            sum += data[i];
-        return sum;
-    } else {
-        size_t mid = start + length / 2;
-        auto left = std::async(std::launch::async, async_sum, std::cref(data), start, mid, min_per_task);
-        long long right_sum = async_sum(data, mid, end, min_per_task);
-        return left.get() + right_sum;
+struct SimdKernelInfo {
+    SumKernelFn<int, long long> fn;
+    const char* name;
+};
+
+// Picks the widest kernel supported by both the CPU and the OS
+SimdKernelInfo detect_simd_kernel() {
+#if defined(SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool avxState = (xcr0 & 0x6) == 0x6;
+    bool avx512State = (xcr0 & 0xe6) == 0xe6;
+    bool avx2 = false, avx512 = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = avxState && (info[1] & (1 << 5)) != 0;
+        avx512 = avx512State && (info[1] & (1 << 16)) != 0;
     }
+#else
+    __builtin_cpu_init();
+    bool sse41 = __builtin_cpu_supports("sse4.1");
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+#endif
+    if (avx512)
+        return {avx512_sum_kernel, "avx512"};
+    if (avx2)
+        return {avx2_sum_kernel, "avx2"};
+    if (sse41)
+        return {sse4_sum_kernel, "sse4.1"};
+#elif defined(SIMD_NEON)
+    return {neon_sum_kernel, "neon"};
+#endif
+    return {scalar_sum_kernel<int, long long>, "scalar"};
 }
 
-void benchmark_thread_scaling(const std::vector<int>& data) {
-    std::cout << "\n=== Thread Scaling Analysis ===\n";
-    std::cout << std::left << std::setw(10) << "Threads"
-              << std::setw(20) << "Atomic Sum (ms)"
-              << std::setw(20) << "Reduce Sum (ms)"
-              << std::setw(22) << "ThreadPool Sum (ms)"
-              << std::setw(22) << "Thread Overhead (ms)" << "\n";
-    std::cout << zen::repeat("-", 94) << "\n";
+const SimdKernelInfo& simd_kernel() {
+    static const SimdKernelInfo info = detect_simd_kernel();
+    return info;
+}
 
-    std::vector<unsigned int> threadCounts = {1, 2, 4, 8, 12, 16};
-    unsigned int maxThreads = std::thread::hardware_concurrency();
-    if (maxThreads > 16) {
-        threadCounts.push_back(maxThreads);
+template<class T, class Acc = accumulator_t<T>>
+SumKernelFn<T, Acc> sum_kernel(SumKernel kernel) {
+    if (kernel == SumKernel::Scalar)
+        return scalar_sum_kernel<T, Acc>;
+    if constexpr (std::is_floating_point_v<Acc>) {
+        if (kernel == SumKernel::Kahan)
+            return kahan_sum_kernel<T, Acc>;
+        if (kernel == SumKernel::Neumaier)
+            return neumaier_sum_kernel<T, Acc>;
+        if (kernel == SumKernel::Pairwise)
+            return pairwise_sum_kernel<T, Acc>;
     }
+    if constexpr (std::is_same_v<T, int> && std::is_same_v<Acc, long long>)
+        return simd_kernel().fn;
+    else
+        return unrolled_sum_kernel<T, Acc>;
+}
 
-    for (unsigned int numThreads : threadCounts) {
-        if (numThreads > maxThreads && numThreads != maxThreads) continue;
+template<class T, class Acc = accumulator_t<T>>
+const char* simd_kernel_name() {
+    if constexpr (std::is_same_v<T, int> && std::is_same_v<Acc, long long>)
+        return simd_kernel().name;
+    else
+        return "unrolled";
+}
 
-        // Atomic sum benchmark with thread timing
-        std::atomic<long long> atomicTotal(0);
-        double atomicCreationTime = 0, atomicJoinTime = 0;
-        double atomicTime = measure_time([&]() {
-            atomic_sum(data, atomicTotal, std::memory_order_relaxed, numThreads, &atomicCreationTime, &atomicJoinTime);
-        });
+// Portable kernels built again for AVX2 and AVX-512: Kernel, and everything it calls, must be
+// SIMD_INLINE so that it is inlined into these wrappers and its loops get the wider instructions.
+// pick() returns the variant for the vector width the int32 sum kernel was detected with.
+template<auto Kernel, class Fn = decltype(Kernel)>
+struct WidestVariant;
 
-        // Reduce sum benchmark with thread timing
-        std::vector<long long> partialSums(numThreads, 0);
-        double reduceCreationTime = 0, reduceJoinTime = 0;
-        double reduceTime = measure_time([&]() {
-            reduce_sum(data, partialSums, numThreads, &reduceCreationTime, &reduceJoinTime);
-        });
+template<auto Kernel, class R, class... Args>
+struct WidestVariant<Kernel, R (*)(Args...)> {
+#if defined(SIMD_X86)
+    SIMD_TARGET("avx2")
+    static R avx2(Args... args) { return Kernel(args...); }
 
-        // ThreadPool sum benchmark
-        std::atomic<long long> poolTotal(0);
-        double poolTime = measure_time([&]() {
-            threadpool_sum(data, poolTotal, numThreads);
-        });
+    SIMD_TARGET("avx512f")
+    static R avx512(Args... args) { return Kernel(args...); }
+#endif
 
-        // Calculate average thread overhead (creation + join)
-        double avgThreadOverhead = (atomicCreationTime + atomicJoinTime + reduceCreationTime + reduceJoinTime) / 2.0;
+    static R (*pick())(Args...) {
+#if defined(SIMD_X86)
+        std::string_view isa = simd_kernel().name;
+        if (isa == "avx512")
+            return avx512;
+        if (isa == "avx2")
+            return avx2;
+#endif
+        return Kernel;
+    }
+};
 
-        std::cout << std::setw(10) << numThreads
-                  << std::fixed << std::setprecision(2)
-                  << std::setw(20) << atomicTime
-                  << std::setw(20) << reduceTime
-                  << std::setw(22) << poolTime
-                  << std::setw(22) << avgThreadOverhead << "\n";
+// NUMA Placement and Thread Pinning
+//
+// Linux places every page on the NUMA node of the thread that first writes it. Workers in every
+// method are numbered 0..numThreads-1 and thread i always sums chunk i of the static split, so
+// filling chunk i from worker i keeps each chunk local to the node that later reads it. With
+// --pin every thread numbered i is bound to the same CPU, spreading consecutive indices over the
+// NUMA nodes round-robin.
+struct CpuTopology {
+    std::vector<std::vector<unsigned int>> nodes;   // CPUs of every NUMA node
+    std::vector<unsigned int> order;                // CPU for worker index i (modulo size)
+};
+
+// Parses a sysfs CPU list such as "0-3,8-11"
+std::vector<unsigned int> parse_cpu_list(const std::string& list) {
+    std::vector<unsigned int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || !std::isdigit(static_cast<unsigned char>(range[0])))
+            continue;
+        size_t dash = range.find('-');
+        unsigned int first = std::stoul(range.substr(0, dash));
+        unsigned int last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        for (unsigned int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
     }
+    return cpus;
 }
 
-void benchmark_workload_scaling() {
-    std::cout << "\n=== Workload Scaling Analysis ===\n";
-    std::cout << std::left << std::setw(15) << "Data Size"
-              << std::setw(15) << "Threads (ms)"
-              << std::setw(18) << "ThreadPool (ms)"
-              << std::setw(18) << "Async (ms)"
-              << std::setw(18) << "Speedup T/TP"
-              << std::setw(18) << "Speedup T/Async" << "\n";
-    std::cout << zen::repeat("-", 100) << "\n";
+CpuTopology query_topology() {
+    CpuTopology topology;
+#if defined(__linux__)
+    for (unsigned int node = 0;; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file)
+            break;
+        std::string list;
+        std::getline(file, list);
+        auto cpus = parse_cpu_list(list);
+        if (!cpus.empty())
+            topology.nodes.push_back(std::move(cpus));
+    }
+#endif
+    if (topology.nodes.empty()) {
+        // No topology information: one node holding every CPU
+        unsigned int count = std::max(std::thread::hardware_concurrency(), 1u);
+        topology.nodes.emplace_back(count);
+        std::iota(topology.nodes[0].begin(), topology.nodes[0].end(), 0u);
+    }
 
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0)
-        numThreads = 4;
+    // Round-robin over the nodes, so that consecutive workers land on different nodes
+    for (size_t i = 0;; ++i) {
+        bool any = false;
+        for (const auto& cpus : topology.nodes) {
+            if (i < cpus.size()) {
+                topology.order.push_back(cpus[i]);
+                any = true;
+            }
+        }
+        if (!any)
+            break;
+    }
+    return topology;
+}
 
-    std::vector<size_t> workloadSizes = {1000000, 5000000, 10000000, 50000000, 100000000};
+const CpuTopology& cpu_topology() {
+    static const CpuTopology topology = query_topology();
+    return topology;
+}
 
-    for (size_t dataSize : workloadSizes) {
-        std::vector<int> testData(dataSize);
-        std::iota(testData.begin(), testData.end(), 1);
+// Set by --pin; when false every thread floats freely
+inline bool pinThreads = false;
 
-        // Regular threads
-        std::atomic<long long> threadsTotal(0);
-        double threadsTime = measure_time([&]() {
-            atomic_sum(testData, threadsTotal, std::memory_order_relaxed, numThreads);
-        });
+// Binds the calling thread to the CPU assigned to worker index; a no-op unless --pin is given
+void pin_current_thread(size_t index) {
+    if (!pinThreads)
+        return;
+    const auto& order = cpu_topology().order;
+    unsigned int cpu = order[index % order.size()];
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(_WIN32)
+    if (cpu < 64)
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+#else
+    (void)cpu;  // no affinity API (macOS): threads keep floating
+#endif
+}
 
-        // ThreadPool
-        std::atomic<long long> poolTotal(0);
-        double poolTime = measure_time([&]() {
-            threadpool_sum(testData, poolTotal, numThreads);
-        });
+// Value of element index in the benchmark sequence 1, 2, 3, ..., which starts over before the
+// values stop being exactly representable in T (int16 and float), so every sum is known exactly
+template<class T>
+constexpr size_t sequence_period() {
+    if constexpr (std::is_floating_point_v<T>)
+        return size_t(1) << std::numeric_limits<T>::digits;
+    else if constexpr (sizeof(T) < sizeof(int))
+        return static_cast<size_t>(std::numeric_limits<T>::max());
+    else
+        return std::numeric_limits<size_t>::max();
+}
 
-        // Async
-        long long asyncTotal = 0;
-        double asyncTime = measure_time([&]() {
-            asyncTotal = async_sum(testData, 0, testData.size());
-        });
+// Writes the sequence values of elements [firstIndex, firstIndex + out.size()) into out
+template<class T>
+void fill_sequence(std::span<T> out, size_t firstIndex = 0) {
+    constexpr size_t period = sequence_period<T>();
+    size_t value = firstIndex % period;
+    for (auto& x : out) {
+        if (value == period)
+            value = 0;
+        x = static_cast<T>(++value);
+    }
+}
 
-        double speedupTP = threadsTime / poolTime;
-        double speedupAsync = threadsTime / asyncTime;
+// Serial:      the main thread writes everything, so all pages end up on its node
+// Local:       worker i first-touches chunk i of the numThreads-way split it will later sum
+// Interleaved: pages are first-touched round-robin by the workers, spreading every chunk over all nodes
+// Pool:        the shared ThreadPool writes one static chunk per task; the fastest setup, but
+//              which node a chunk lands on depends on which worker runs its task
+enum class Placement { Serial, Local, Interleaved, Pool };
 
-        std::cout << std::setw(15) << dataSize
-                  << std::fixed << std::setprecision(2)
-                  << std::setw(15) << threadsTime
-                  << std::setw(18) << poolTime
-                  << std::setw(18) << asyncTime
-                  << std::setw(18) << speedupTP
-                  << std::setw(18) << speedupAsync << "\n";
+const char* to_string(Placement placement) {
+    switch (placement) {
+    case Placement::Serial:      return "serial";
+    case Placement::Local:       return "local";
+    case Placement::Interleaved: return "interleaved";
+    case Placement::Pool:        return "pool";
     }
+    return "unknown";
 }
 
-int main(int argc, char** argv) {
-    zen::cmd_args args(argv, argc);
-    size_t dataSize = 100000000;
-    if (args.is_present("--n")) {
-        auto n = std::stoi(args.get_options("--n")[0]);
-        if (n > 0)
-            dataSize = n;
+// Cache line size used to keep per-thread accumulators apart
+constexpr size_t cacheLineSize = 64;
+
+// Page backing of large buffers, set by --huge-pages:
+// Off:         ordinary 4 KiB pages, with transparent huge pages disabled for the range
+// Transparent: anonymous memory aligned to hugePageBytes and marked for transparent huge pages
+//              (Linux MADV_HUGEPAGE), which the kernel may or may not grant
+// Explicit:    preallocated huge pages (Linux MAP_HUGETLB, Windows large pages), falling back to
+//              Transparent when none are available
+enum class HugePages { Off, Transparent, Explicit };
+
+const char* to_string(HugePages mode) {
+    switch (mode) {
+    case HugePages::Off:         return "off";
+    case HugePages::Transparent: return "transparent";
+    case HugePages::Explicit:    return "explicit";
     }
+    return "unknown";
+}
 
-    std::vector<int> data(dataSize);
-    std::iota(data.begin(), data.end(), 1);
+inline HugePages hugePages = HugePages::Transparent;
 
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0) numThreads = 2;
+constexpr size_t smallPageBytes = 4096;
+constexpr size_t hugePageBytes = size_t(2) << 20;
 
-    std::cout << "Thread Count: " << numThreads << "\n\n";
-    
-    // Original benchmark
-    std::cout << "=== Basic Performance Comparison ===\n";
-    std::cout << std::left << std::setw(20) << "Method"
-              << std::setw(20) << "Memory Order"
-              << std::setw(20) << "Sum"
-              << std::setw(20) << "Time (ms)" << "\n";
-    std::cout << zen::repeat("-", 80) << "\n";
+// Maps bytes (a multiple of hugePageBytes) of zero-filled memory, which is faulted in page by
+// page on first write. Throws std::bad_alloc when the memory cannot be mapped.
+void* map_pages(size_t bytes, HugePages mode) {
+#if defined(_WIN32)
+    if (mode == HugePages::Explicit) {
+        // Needs the "Lock pages in memory" privilege; without it the call fails
+        size_t largePage = GetLargePageMinimum();
+        if (largePage > 0 && bytes % largePage == 0) {
+            if (void* p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE))
+                return p;
+        }
+    }
+    void* p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+#else
+#if defined(MAP_HUGETLB)
+    if (mode == HugePages::Explicit) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            return p;
+    }
+#endif
+    // Over-map by one huge page and trim both ends, so that the buffer starts on a huge page
+    // boundary and every 2 MiB of it can be backed by one huge page
+    size_t length = bytes + hugePageBytes;
+    void* raw = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        throw std::bad_alloc();
+    uintptr_t start = (reinterpret_cast<uintptr_t>(raw) + hugePageBytes - 1) & ~(hugePageBytes - 1);
+    size_t head = start - reinterpret_cast<uintptr_t>(raw);
+    if (head > 0)
+        munmap(raw, head);
+    munmap(reinterpret_cast<void*>(start + bytes), length - head - bytes);
+    void* p = reinterpret_cast<void*>(start);
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+    madvise(p, bytes, mode == HugePages::Off ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+#endif
+    return p;
+#endif
+}
 
-    for (auto order : {std::memory_order_relaxed, std::memory_order_seq_cst}) {
-        std::atomic<long long> total(0);
-        double time = measure_time([&]() {
-            atomic_sum(data, total, order, numThreads);
-        });
-        print_result("Atomic Sum",
-                     order == std::memory_order_relaxed ? "relaxed" : "seq_cst",
-                     total.load(),
-                     time);
+void unmap_pages(void* p, size_t bytes) {
+#if defined(_WIN32)
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, bytes);
+#endif
+}
+
+// Allocator for the large input buffers. Allocations of at least hugePageBytes are mapped
+// directly with the allocator's HugePages mode, in whole huge pages; smaller ones are cache-line
+// aligned heap blocks. construct() default-initializes, so a vector of n elements leaves its pages
+// untouched until they are first written, by whichever threads fill the data.
+template<class T>
+class PageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    PageAllocator(HugePages mode = hugePages) : mode(mode) {}
+
+    template<class U>
+    PageAllocator(const PageAllocator<U>& other) : mode(other.mode) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_array_new_length();
+        size_t bytes = n * sizeof(T);
+        if (bytes < hugePageBytes)
+            return static_cast<T*>(::operator new(bytes, std::align_val_t(alignment)));
+        return static_cast<T*>(map_pages(mapped_bytes(bytes), mode));
     }
 
-    std::vector<long long> partialSums(numThreads, 0);
-    double reduce_time = measure_time([&]() {
-        reduce_sum(data, partialSums, numThreads);
-    });
+    void deallocate(T* p, size_t n) noexcept {
+        size_t bytes = n * sizeof(T);
+        if (bytes < hugePageBytes)
+            ::operator delete(p, std::align_val_t(alignment));
+        else
+            unmap_pages(p, mapped_bytes(bytes));
+    }
 
-    long long reduceResult = 0;
-    for (auto sum : partialSums) {
-        reduceResult += sum;
+    template<class U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
     }
-    print_result("Reduce Sum", "N/A", reduceResult, reduce_time);
 
-    // ThreadPool benchmark
-    std::atomic<long long> poolTotal(0);
-    double pool_time = measure_time([&]() {
-        threadpool_sum(data, poolTotal, numThreads);
-    });
-    print_result("ThreadPool Sum", "N/A", poolTotal.load(), pool_time);
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
 
-    long long singleThreadResult = 0;
-    double single_thread_time = measure_time([&]() {
-        single_thread_sum(data, singleThreadResult);
-    });
-    print_result("Single-Threaded", "N/A", singleThreadResult, single_thread_time);
+    HugePages huge_pages() const { return mode; }
 
-    // Async benchmark
-    long long asyncResult = 0;
-    double async_time = measure_time([&]() {
-        asyncResult = async_sum(data, 0, data.size());
-    });
-    print_result("Async Sum", "N/A", asyncResult, async_time);
+    // Granularity at which the mapped pages are placed on NUMA nodes
+    size_t page_bytes() const { return mode == HugePages::Off ? smallPageBytes : hugePageBytes; }
 
-    // Advanced benchmarks
-    benchmark_thread_scaling(data);
-    benchmark_workload_scaling();
+    friend bool operator==(const PageAllocator& a, const PageAllocator& b) { return a.mode == b.mode; }
+
+private:
+    template<class> friend class PageAllocator;
+
+    static constexpr size_t alignment = std::max(cacheLineSize, alignof(T));
+
+    static size_t mapped_bytes(size_t bytes) { return (bytes + hugePageBytes - 1) / hugePageBytes * hugePageBytes; }
+
+    HugePages mode;
+};
+
+template<class T>
+using PageVector = std::vector<T, PageAllocator<T>>;
+
+// Page faults of the whole process so far, minor and major; -1 where not available
+long long page_faults() {
+#if !defined(_WIN32)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<long long>(usage.ru_minflt) + usage.ru_majflt;
+#endif
+    return -1;
+}
+
+// Bytes of [data, data + bytes) backed by huge pages, from the mappings in /proc/self/smaps that
+// overlap it; -1 where the kernel does not say
+double huge_page_bytes(const void* data, size_t bytes) {
+#if defined(__linux__)
+    std::ifstream smaps("/proc/self/smaps");
+    if (!smaps)
+        return -1;
+    uintptr_t first = reinterpret_cast<uintptr_t>(data), last = first + bytes;
+    bool overlaps = false;
+    double hugeBytes = 0;
+    for (std::string line; std::getline(smaps, line);) {
+        // A mapping starts with "start-end perms ..."; its fields follow as "Key: value kB"
+        std::istringstream fields(line);
+        size_t space = line.find(' ');
+        if (space != std::string::npos && line.find('-') < space && line.find(':') > space) {
+            uintptr_t start = 0, end = 0;
+            char dash = 0;
+            fields >> std::hex >> start >> dash >> end;
+            overlaps = start < last && first < end;
+            continue;
+        }
+        std::string key;
+        double kb = 0;
+        if (overlaps && (fields >> key >> kb)
+            && (key == "AnonHugePages:" || key == "Shared_Hugetlb:" || key == "Private_Hugetlb:"))
+            hugeBytes += kb * 1024;
+    }
+    return std::min(hugeBytes, double(bytes));
+#else
+    (void)data;
+    (void)bytes;
+    return -1;
+#endif
+}
+
+template<class T, class Pool>
+void fill_sequence_parallel(std::span<T> out, Pool& pool);
+
+// Input buffer whose pages are left untouched on allocation, so that the placement
+// decides which thread (and therefore which NUMA node) touches them first
+template<class T>
+class PlacedBuffer {
+public:
+    // Placement::Pool needs the pool constructor below; here it places like Local
+    PlacedBuffer(size_t size, Placement placement, unsigned int numThreads) : storage(size) {
+        std::span<T> out(storage);
+        size_t pageElements = std::max<size_t>(storage.get_allocator().page_bytes() / sizeof(T), 1);
+        if (placement == Placement::Serial || numThreads <= 1) {
+            fill_sequence(out);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        size_t chunk = out.size() / numThreads;
+        for (unsigned int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([out, placement, numThreads, chunk, pageElements, i]() {
+                pin_current_thread(i);
+                if (placement != Placement::Interleaved) {
+                    size_t start = i * chunk;
+                    size_t end = (i == numThreads - 1) ? out.size() : start + chunk;
+                    fill_sequence(out.subspan(start, end - start), start);
+                } else {
+                    for (size_t page = i * pageElements; page < out.size(); page += numThreads * pageElements) {
+                        size_t length = std::min(pageElements, out.size() - page);
+                        fill_sequence(out.subspan(page, length), page);
+                    }
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+
+    // Placement::Pool
+    template<class Pool>
+    PlacedBuffer(size_t size, Pool& pool) : storage(size) {
+        fill_sequence_parallel(std::span<T>(storage), pool);
+    }
+
+    std::span<const T> view() const { return storage; }
+
+private:
+    PageVector<T> storage;
+};
+
+// Hardware performance counters (Linux perf_event_open). A PerfRegion counts user-space events of
+// the calling thread and of every thread it creates while open; a created thread's counts are
+// folded in when it exits. So the counts are complete for methods that start and join their own
+// threads (atomic, reduce, async, single-threaded), but miss persistent pool workers. The
+// coherence event (e.g. HITM loads) has no generic perf encoding and is taken as a raw,
+// model-specific event code from --perf-coherence. dTLB load misses are counted where the CPU
+// exposes them, without failing the region where it does not.
+enum PerfEvent { PerfCycles, PerfInstructions, PerfLlcMisses, PerfCoherence, PerfDtlbMisses, PerfEventCount };
+
+inline bool perfCounters = false;
+inline uint64_t perfCoherenceEvent = 0;     // raw event code, 0: not counted
+
+class PerfRegion {
+public:
+    PerfRegion() {
+        fds.fill(-1);
+#if defined(__linux__)
+        const std::pair<uint32_t, uint64_t> events[PerfEventCount] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_RAW, perfCoherenceEvent},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        };
+        for (int e = 0; e < PerfEventCount; ++e) {
+            if (e == PerfCoherence && perfCoherenceEvent == 0)
+                continue;
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[e].first;
+            attr.config = events[e].second;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds[e] < 0 && error.empty() && e != PerfDtlbMisses)
+                error = std::strerror(errno);
+        }
+        for (int fd : fds) {
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#else
+        error = "not supported on this platform";
+#endif
+    }
+
+    PerfRegion(const PerfRegion&) = delete;
+    PerfRegion& operator=(const PerfRegion&) = delete;
+
+    ~PerfRegion() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0)
+                close(fd);
+        }
+#endif
+    }
+
+    // Stops counting and returns the counts, scaled up if the kernel multiplexed the counters;
+    // negative for events that could not be opened
+    std::array<double, PerfEventCount> stop() {
+        std::array<double, PerfEventCount> counts;
+        counts.fill(-1);
+#if defined(__linux__)
+        for (int e = 0; e < PerfEventCount; ++e) {
+            if (fds[e] < 0)
+                continue;
+            ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t values[3] = {};
+            if (read(fds[e], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)) && values[2] > 0)
+                counts[e] = double(values[0]) * double(values[1]) / double(values[2]);
+        }
+#endif
+        return counts;
+    }
+
+    // Why the first event that failed could not be opened; empty if all opened
+    const std::string& failure() const { return error; }
+
+private:
+    std::array<int, PerfEventCount> fds;
+    std::string error;
+};
+
+// Read-only memory mapping of a binary column file. The mapped pages are fed straight into the
+// summation methods as a span, without copying; the kernel pages them in on demand, so the file
+// may be larger than RAM.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("cannot open " + zen::quote(path));
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("cannot stat " + zen::quote(path));
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) {
+                CloseHandle(file);
+                throw std::runtime_error("cannot map " + zen::quote(path));
+            }
+            address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!address) {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::runtime_error("cannot map " + zen::quote(path));
+            }
+        }
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + zen::quote(path));
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("cannot stat " + zen::quote(path));
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("cannot map " + zen::quote(path));
+            }
+            // Hints only: read ahead aggressively, and back the mapping with huge pages where supported
+            madvise(address, length, MADV_SEQUENTIAL);
+            madvise(address, length, MADV_WILLNEED);
+#if defined(MADV_HUGEPAGE)
+            madvise(address, length, MADV_HUGEPAGE);
+#endif
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (address)
+            UnmapViewOfFile(address);
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        if (address)
+            munmap(address, length);
+        close(fd);
+#endif
+    }
+
+    // The file as an array of T; trailing bytes that do not fill a whole element are ignored
+    template<class T>
+    std::span<const T> as() const {
+        return {static_cast<const T*>(address), address ? length / sizeof(T) : 0};
+    }
+
+    size_t size() const { return length; }
+
+private:
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+    void* address = nullptr;
+    size_t length = 0;
+};
+
+// Double-quoted JSON string literal
+std::string json_string(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+            quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Per-worker timeline of the thread-spawning methods. Workers append (start, compute end, publish)
+// timestamps into a preallocated buffer by claiming a slot with one fetch_add, so recording takes
+// no lock and never allocates; events beyond the capacity are counted and dropped. Timestamps are
+// nanoseconds since the buffer was created, and a run groups the events of one method call.
+struct TraceEvent {
+    uint32_t run;
+    uint32_t worker;
+    uint64_t startNs;       // worker began
+    uint64_t computeNs;     // its chunk was summed
+    uint64_t publishNs;     // its result reached the shared total or slot
+};
+
+struct TraceRun {
+    std::string label;
+    unsigned int threads;
+    uint64_t dispatchNs;    // first thread was created
+};
+
+class TraceBuffer {
+public:
+    explicit TraceBuffer(size_t capacity) : events(capacity), epoch(std::chrono::steady_clock::now()) {}
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    // Called by the dispatching thread before it creates the workers of a run
+    uint32_t begin_run(const std::string& label, unsigned int threads) {
+        runs.push_back({label, threads, now()});
+        return static_cast<uint32_t>(runs.size() - 1);
+    }
+
+    // Safe to call from any number of workers at once
+    void record(const TraceEvent& event) {
+        size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+        if (slot < events.size())
+            events[slot] = event;
+        else
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Only once the workers that recorded have been joined
+    std::vector<TraceEvent> run_events(uint32_t run) const {
+        std::vector<TraceEvent> result;
+        for (size_t i = 0; i < recorded(); ++i) {
+            if (events[i].run == run)
+                result.push_back(events[i]);
+        }
+        return result;
+    }
+
+    size_t recorded() const { return std::min(next.load(), events.size()); }
+    size_t dropped_events() const { return dropped.load(); }
+    const std::vector<TraceRun>& trace_runs() const { return runs; }
+
+    // Chrome trace event format (chrome://tracing, Perfetto): one process per run, one thread
+    // per worker, with a compute and a publish span per worker
+    void write_chrome_trace(std::ostream& out) const {
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        out << std::fixed << std::setprecision(3);
+        bool first = true;
+        auto separator = [&out, &first]() {
+            out << (first ? "" : ",\n");
+            first = false;
+        };
+        for (size_t r = 0; r < runs.size(); ++r) {
+            separator();
+            out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << r
+                << ", \"args\": {\"name\": " << json_string(runs[r].label + " x" + std::to_string(runs[r].threads)) << "}}";
+        }
+        for (size_t i = 0; i < recorded(); ++i) {
+            const TraceEvent& e = events[i];
+            uint64_t dispatch = runs[e.run].dispatchNs;
+            separator();
+            out << "{\"name\": \"compute\", \"ph\": \"X\", \"pid\": " << e.run << ", \"tid\": " << e.worker
+                << ", \"ts\": " << e.startNs / 1000.0 << ", \"dur\": " << (e.computeNs - e.startNs) / 1000.0
+                << ", \"args\": {\"start_after_dispatch_us\": " << (e.startNs - dispatch) / 1000.0 << "}}";
+            separator();
+            out << "{\"name\": \"publish\", \"ph\": \"X\", \"pid\": " << e.run << ", \"tid\": " << e.worker
+                << ", \"ts\": " << e.computeNs / 1000.0 << ", \"dur\": " << (e.publishNs - e.computeNs) / 1000.0 << "}";
+        }
+        out << "\n]}\n";
+    }
+
+private:
+    std::vector<TraceEvent> events;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> dropped{0};
+    std::vector<TraceRun> runs;
+    std::chrono::steady_clock::time_point epoch;
+};
+
+constexpr size_t traceCapacity = size_t(1) << 16;
+
+// Trace shared by every traced run of the program, exported by --trace
+TraceBuffer& worker_trace() {
+    static TraceBuffer trace(traceCapacity);
+    return trace;
+}
+
+// Spread between the fastest and the slowest worker of every run, to spot stragglers
+void print_worker_timeline(const TraceBuffer& trace, const std::vector<uint32_t>& runs) {
+    std::cout << "\n=== Worker Timeline ===\n";
+    std::cout << std::left << std::setw(22) << "Method"
+              << std::setw(9) << "Threads"
+              << std::setw(19) << "Start Spread (ms)"
+              << std::setw(18) << "Compute Min (ms)"
+              << std::setw(18) << "Compute Max (ms)"
+              << std::setw(20) << "Finish Spread (ms)"
+              << std::setw(12) << "Imbalance" << "\n";
+    std::cout << zen::repeat("-", 118) << "\n";
+
+    for (uint32_t run : runs) {
+        auto events = trace.run_events(run);
+        if (events.empty())
+            continue;
+        double startMin = INFINITY, startMax = 0, computeMin = INFINITY, computeMax = 0, computeTotal = 0;
+        double finishMin = INFINITY, finishMax = 0;
+        uint64_t dispatch = trace.trace_runs()[run].dispatchNs;
+        for (const auto& e : events) {
+            double start = (e.startNs - dispatch) / 1e6;
+            double compute = (e.computeNs - e.startNs) / 1e6;
+            double finish = (e.publishNs - dispatch) / 1e6;
+            startMin = std::min(startMin, start);
+            startMax = std::max(startMax, start);
+            computeMin = std::min(computeMin, compute);
+            computeMax = std::max(computeMax, compute);
+            computeTotal += compute;
+            finishMin = std::min(finishMin, finish);
+            finishMax = std::max(finishMax, finish);
+        }
+        double computeMean = computeTotal / events.size();
+        const TraceRun& info = trace.trace_runs()[run];
+        std::cout << std::setw(22) << info.label
+                  << std::setw(9) << info.threads
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(19) << startMax - startMin
+                  << std::setw(18) << computeMin
+                  << std::setw(18) << computeMax
+                  << std::setw(20) << finishMax - finishMin
+                  << std::setprecision(2)
+                  << std::setw(12) << (computeMean > 0 ? computeMax / computeMean : 1.0) << "\n";
+    }
+    if (trace.dropped_events() > 0)
+        std::cout << trace.dropped_events() << " events dropped, trace buffer full\n";
+}
+
+// How the parallel methods split [0, size) between their workers:
+// Static:  one equal chunk per worker, the remainder going to the last one
+// Dynamic: workers repeatedly claim the next dynamicBlockSize elements from a shared atomic cursor
+// Guided:  like Dynamic, but every claim takes 1/(2 * workers) of what is left, shrinking down
+//          to guidedMinBlock, so early claims are cheap and late ones even out the finish
+// The claiming schedules let fast cores take more blocks than slow or busy ones.
+enum class Schedule { Static, Dynamic, Guided };
+
+const char* to_string(Schedule schedule) {
+    switch (schedule) {
+    case Schedule::Static: return "static";
+    case Schedule::Dynamic: return "dynamic";
+    case Schedule::Guided: return "guided";
+    }
+    return "unknown";
+}
+
+constexpr size_t dynamicBlockSize = 65536;
+constexpr size_t guidedMinBlock = 16384;
+
+class ChunkScheduler {
+public:
+    ChunkScheduler(size_t size, size_t workers, Schedule schedule)
+        : size(size), workers(std::max<size_t>(workers, 1)), schedule(schedule) {}
+
+    // Calls body(start, end) for every range worker gets
+    template<class Body>
+    void for_each_range(size_t worker, Body&& body) {
+        if (schedule == Schedule::Static) {
+            size_t chunk = size / workers;
+            size_t start = worker * chunk;
+            body(start, worker == workers - 1 ? size : start + chunk);
+            return;
+        }
+        while (true) {
+            size_t start, block;
+            if (schedule == Schedule::Dynamic) {
+                block = dynamicBlockSize;
+                start = cursor.fetch_add(block, std::memory_order_relaxed);
+                if (start >= size)
+                    return;
+            } else {
+                start = cursor.load(std::memory_order_relaxed);
+                do {
+                    if (start >= size)
+                        return;
+                    block = std::max(guidedMinBlock, (size - start) / (2 * workers));
+                } while (!cursor.compare_exchange_weak(start, start + block, std::memory_order_relaxed));
+            }
+            body(start, std::min(size, start + block));
+        }
+    }
+
+private:
+    size_t size;
+    size_t workers;
+    Schedule schedule;
+    alignas(cacheLineSize) std::atomic<size_t> cursor{0};
+};
+
+template<class T, class Acc>
+void atomic_sum(std::span<const T> data, std::atomic<Acc>& total,
+                std::memory_order order, unsigned int numThreads, SumKernel kernel = SumKernel::Simd,
+                Schedule schedule = Schedule::Static,
+                double* creation_time = nullptr, double* join_time = nullptr,
+                TraceBuffer* trace = nullptr, const std::string& traceLabel = "Atomic Sum") {
+    std::vector<std::thread> threads;
+    ChunkScheduler scheduler(data.size(), numThreads, schedule);
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+    uint32_t run = trace ? trace->begin_run(traceLabel, numThreads) : 0;
+
+    auto worker = [data, &total, order, sum, &scheduler, trace, run](unsigned int tid) {
+        uint64_t startNs = trace ? trace->now() : 0;
+        pin_current_thread(tid);
+        Acc localSum = 0;
+        scheduler.for_each_range(tid, [&](size_t start, size_t end) {
+            localSum += sum(data.data() + start, end - start);
+        });
+        uint64_t computeNs = trace ? trace->now() : 0;
+        atomic_add(total, localSum, order);
+        if (trace)
+            trace->record({run, tid, startNs, computeNs, trace->now()});
+    };
+
+    // Measure thread creation time
+    auto creation_timer = zen::timer();
+    if (creation_time)
+        creation_timer.start();
+    
+    for (unsigned int i = 0; i < numThreads; ++i)
+        threads.emplace_back(worker, i);
+    
+    if (creation_time) {
+        creation_timer.stop();
+        *creation_time = creation_timer.duration<zen::timer::usec>().count() / 1000.0;
+    }
+
+    // Measure join time
+    auto join_timer = zen::timer();
+    if (join_time)
+        join_timer.start();
+    
+    for (auto& t : threads)
+        t.join();
+        
+    if (join_time) {
+        join_timer.stop();
+        *join_time = join_timer.duration<zen::timer::usec>().count() / 1000.0;
+    }
+}
+
+// Partial sum (or aggregate) occupying a whole cache line, so neighbouring threads never share one
+template<class Acc>
+struct alignas(cacheLineSize) PaddedSum {
+    Acc value{};
+};
+
+// Naive:  every thread accumulates straight into partialSums[tid] (adjacent slots, false sharing)
+// Padded: every thread accumulates into its own cache-line-aligned slot, copied out after join
+enum class ReduceLayout { Naive, Padded };
+
+// With the scalar kernel every element is added into the slot. The other kernels keep their
+// accumulators in registers, so they add one block at a time to keep the slot traffic visible.
+constexpr size_t reduceBlockSize = 256;
+
+template<class T, class Acc>
+void accumulate_range(Acc& slot, const T* data, size_t count, SumKernel kernel) {
+    if (kernel == SumKernel::Scalar) {
+        for (size_t i = 0; i < count; ++i)
+            slot += data[i];
+        return;
+    }
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+    for (size_t i = 0; i < count; i += reduceBlockSize)
+        slot += sum(data + i, std::min(reduceBlockSize, count - i));
+}
+
+template<class T, class Acc>
+void reduce_sum(std::span<const T> data, std::vector<Acc>& partialSums,
+                unsigned int numThreads, ReduceLayout layout = ReduceLayout::Naive,
+                SumKernel kernel = SumKernel::Simd, Schedule schedule = Schedule::Static,
+                double* creation_time = nullptr, double* join_time = nullptr,
+                TraceBuffer* trace = nullptr, const std::string& traceLabel = "Reduce Sum") {
+    std::vector<std::thread> threads;
+    std::vector<PaddedSum<Acc>> paddedSums(layout == ReduceLayout::Padded ? numThreads : 0);
+    ChunkScheduler scheduler(data.size(), numThreads, schedule);
+    uint32_t run = trace ? trace->begin_run(traceLabel, numThreads) : 0;
+
+    // Both layouts publish as they accumulate, so compute end and publish coincide
+    auto naive_worker = [data, &partialSums, kernel, &scheduler, trace, run](unsigned int tid) {
+        uint64_t startNs = trace ? trace->now() : 0;
+        pin_current_thread(tid);
+        scheduler.for_each_range(tid, [&](size_t start, size_t end) {
+            accumulate_range(partialSums[tid], data.data() + start, end - start, kernel);
+        });
+        if (trace) {
+            uint64_t doneNs = trace->now();
+            trace->record({run, tid, startNs, doneNs, doneNs});
+        }
+    };
+
+    auto padded_worker = [data, &paddedSums, kernel, &scheduler, trace, run](unsigned int tid) {
+        uint64_t startNs = trace ? trace->now() : 0;
+        pin_current_thread(tid);
+        scheduler.for_each_range(tid, [&](size_t start, size_t end) {
+            accumulate_range(paddedSums[tid].value, data.data() + start, end - start, kernel);
+        });
+        if (trace) {
+            uint64_t doneNs = trace->now();
+            trace->record({run, tid, startNs, doneNs, doneNs});
+        }
+    };
+
+    // Measure thread creation time
+    auto creation_timer = zen::timer();
+    if (creation_time) creation_timer.start();
+    
+    for (unsigned int i = 0; i < numThreads; ++i) {
+        if (layout == ReduceLayout::Padded)
+            threads.emplace_back(padded_worker, i);
+        else
+            threads.emplace_back(naive_worker, i);
+    }
+    
+    if (creation_time) {
+        creation_timer.stop();
+        *creation_time = creation_timer.duration<zen::timer::usec>().count() / 1000.0;
+    }
+
+    // Measure join time
+    auto join_timer = zen::timer();
+    if (join_time) join_timer.start();
+    
+    for (auto& t : threads)
+        t.join();
+        
+    if (join_time) {
+        join_timer.stop();
+        *join_time = join_timer.duration<zen::timer::usec>().count() / 1000.0;
+    }
+
+    for (unsigned int i = 0; i < paddedSums.size(); ++i)
+        partialSums[i] += paddedSums[i].value;
+}
+
+template<class T, class Acc>
+void single_thread_sum(std::span<const T> data, Acc& result,
+                       SumKernel kernel = SumKernel::Simd) {
+    result = sum_kernel<T, Acc>(kernel)(data.data(), data.size());
+}
+
+// Number of calls of the global operator new, for the Task Allocation Analysis. Replacing the
+// global operators affects every allocation in the program, so the counting replacements are only
+// built with PARALLEL_SUM_COUNT_ALLOCATIONS (the CMake option of the same name). The array forms
+// are replaced as well, so that every new and delete pair ends in malloc and free; the aligned
+// forms keep their library versions, which pair with each other.
+inline std::atomic<uint64_t> allocationCount{0};
+
+#if defined(PARALLEL_SUM_COUNT_ALLOCATIONS)
+constexpr bool countAllocations = true;
+
+void* counted_allocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return counted_allocate(size); }
+void* operator new[](std::size_t size) { return counted_allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#else
+constexpr bool countAllocations = false;
+#endif
+
+// Move-only task for the ThreadPool queue. Callables of up to taskInlineBytes live inside the
+// task, so that submitting one of the lambdas in this file does not allocate; bigger ones
+// fall back to the heap. With the operations pointer, a task is 96 bytes.
+constexpr size_t taskInlineBytes = 88;
+
+class InlineTask {
+public:
+    InlineTask() = default;
+
+    template<class F, class Fn = std::decay_t<F>,
+             std::enable_if_t<!std::is_same_v<Fn, InlineTask>, int> = 0>
+    InlineTask(F&& f) {
+        if constexpr (fits_inline<Fn>()) {
+            new (storage) Fn(std::forward<F>(f));
+            ops = &inline_ops<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+            ops = &heap_ops<Fn>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) noexcept { take(other); }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~InlineTask() { reset(); }
+
+    explicit operator bool() const { return ops != nullptr; }
+
+    void operator()() { ops->invoke(storage); }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<class Fn>
+    static constexpr bool fits_inline() {
+        return sizeof(Fn) <= taskInlineBytes && alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template<class Fn>
+    static constexpr Ops inline_ops = {
+        [](void* storage) { (*static_cast<Fn*>(storage))(); },
+        [](void* from, void* to) noexcept {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* storage) noexcept { static_cast<Fn*>(storage)->~Fn(); },
+    };
+
+    template<class Fn>
+    static constexpr Ops heap_ops = {
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* from, void* to) noexcept { *static_cast<Fn**>(to) = *static_cast<Fn**>(from); },
+        [](void* storage) noexcept { delete *static_cast<Fn**>(storage); },
+    };
+
+    void take(InlineTask& other) noexcept {
+        if (other.ops) {
+            other.ops->relocate(other.storage, storage);
+            ops = std::exchange(other.ops, nullptr);
+        }
+    }
+
+    void reset() noexcept {
+        if (ops)
+            std::exchange(ops, nullptr)->destroy(storage);
+    }
+
+    alignas(std::max_align_t) unsigned char storage[taskInlineBytes];
+    const Ops* ops = nullptr;
+};
+
+// FIFO of tasks in a power-of-two ring. It doubles when full and never shrinks, so once it has
+// grown to the largest batch a program submits, pushing and popping do not allocate.
+constexpr size_t taskRingCapacity = 1024;
+
+class TaskRing {
+public:
+    TaskRing() : slots(taskRingCapacity) {}
+
+    bool empty() const { return head == tail; }
+
+    void push_back(InlineTask&& task) {
+        if (tail - head == slots.size())
+            grow();
+        slots[tail++ & (slots.size() - 1)] = std::move(task);
+    }
+
+    InlineTask pop_front() { return std::move(slots[head++ & (slots.size() - 1)]); }
+    InlineTask pop_back() { return std::move(slots[--tail & (slots.size() - 1)]); }
+
+private:
+    void grow() {
+        std::vector<InlineTask> larger(slots.size() * 2);
+        for (size_t i = head; i != tail; ++i)
+            larger[i - head] = std::move(slots[i & (slots.size() - 1)]);
+        tail -= head;
+        head = 0;
+        slots = std::move(larger);
+    }
+
+    std::vector<InlineTask> slots;
+    size_t head = 0;
+    size_t tail = 0;
+};
+
+// Thread Pool Implementation
+class ThreadPool {
+public:
+    ThreadPool(size_t numThreads) : stop(false) {
+        start_workers(numThreads);
+    }
+
+    template<class F>
+    void enqueue(F&& f) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (stop)
+                throw std::runtime_error("enqueue on stopped ThreadPool");
+            tasks.push_back(InlineTask(std::forward<F>(f)));
+        }
+        condition.notify_one();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // True when called from one of this pool's worker threads
+    bool is_worker() const { return currentPool == this; }
+
+    // Runs one queued task on the calling thread, if there is one. Lets a thread that
+    // waits for pool work help out instead of blocking. Takes the newest task (usually the
+    // waiter's own child), so helping does not nest ever larger subtrees on the stack.
+    bool try_run_one() {
+        InlineTask task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (tasks.empty())
+                return false;
+            task = tasks.pop_back();
+        }
+        task();
+        return true;
+    }
+
+    // Drains the queue and restarts the pool with numThreads workers.
+    // Must not be called while tasks are still being enqueued.
+    void resize(size_t numThreads) {
+        if (numThreads == workers.size())
+            return;
+        stop_workers();
+        stop = false;
+        start_workers(numThreads);
+    }
+
+    ~ThreadPool() {
+        stop_workers();
+    }
+
+private:
+    void start_workers(size_t numThreads) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this, i] {
+                currentPool = this;
+                pin_current_thread(i);
+                while (true) {
+                    InlineTask task;
+                    {
+                        std::unique_lock<std::mutex> lock(this->queueMutex);
+                        this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
+                        if (this->stop && this->tasks.empty())
+                            return;
+                        task = this->tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    void stop_workers() {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            stop = true;
+        }
+        condition.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+        workers.clear();
+    }
+
+    static inline thread_local ThreadPool* currentPool = nullptr;
+
+    std::vector<std::thread> workers;
+    TaskRing tasks;
+    std::mutex queueMutex;
+    std::condition_variable condition;
+    bool stop;
+};
+
+// Hint to the CPU that the calling thread is spin-waiting
+inline void cpu_relax() {
+#if defined(SIMD_X86)
+    _mm_pause();
+#elif defined(SIMD_NEON) && defined(_MSC_VER) && !defined(__clang__)
+    __yield();
+#elif defined(SIMD_NEON)
+    asm volatile("yield");
+#endif
+}
+
+// Completion latch for a batch of pool tasks: every task counts down once when it is done, and
+// the dispatching thread waits for the count to reach zero. Finishing tasks share no lock, and
+// the waiter spins for latchSpinRounds pauses before it parks on the counter with std::atomic::wait,
+// since the tasks of a small sum are often done within a few microseconds.
+constexpr unsigned int latchSpinRounds = 256;
+
+class CompletionLatch {
+public:
+    explicit CompletionLatch(size_t count) : remaining(static_cast<uint32_t>(count)), released(count == 0) {}
+
+    CompletionLatch(const CompletionLatch&) = delete;
+    CompletionLatch& operator=(const CompletionLatch&) = delete;
+
+    void count_down() {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            remaining.notify_one();
+            // Last access to the latch: wait() does not return before this store, so the latch
+            // can live on the waiter's stack
+            released.store(true, std::memory_order_release);
+        }
+    }
+
+    void wait() {
+        // With a single hardware thread, spinning only delays the tasks being waited for
+        static const unsigned int spinRounds = std::thread::hardware_concurrency() > 1 ? latchSpinRounds : 0;
+        for (unsigned int i = 0; i < spinRounds; ++i) {
+            if (released.load(std::memory_order_acquire))
+                return;
+            cpu_relax();
+        }
+        for (uint32_t count = remaining.load(std::memory_order_acquire); count != 0;
+             count = remaining.load(std::memory_order_acquire))
+            remaining.wait(count, std::memory_order_acquire);
+        // The last task is between its decrement and the store above
+        while (!released.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+
+private:
+    // 32 bits, so that wait() parks on a futex rather than on a proxy word
+    std::atomic<uint32_t> remaining;
+    std::atomic<bool> released;
+};
+
+// Writes the benchmark sequence into out on the pool, one static chunk per task, so that the page
+// faults and stores of a large input are spread over all workers
+constexpr size_t parallelFillElements = 1 << 16;
+
+template<class T, class Pool>
+void fill_sequence_parallel(std::span<T> out, Pool& pool) {
+    size_t numTasks = std::min(pool.size(), out.size() / parallelFillElements);
+    if (numTasks <= 1) {
+        fill_sequence(out);
+        return;
+    }
+    ChunkScheduler scheduler(out.size(), numTasks, Schedule::Static);
+    CompletionLatch latch(numTasks);
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.enqueue([out, &scheduler, &latch, i]() {
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                fill_sequence(out.subspan(start, end - start), start);
+            });
+            latch.count_down();
+        });
+    }
+    latch.wait();
+}
+
+// Work-Stealing Thread Pool Implementation
+//
+// Every worker owns a Chase-Lev deque: the owner pushes and pops at the bottom without locking,
+// idle workers steal from the top of a randomly chosen victim. Tasks enqueued from outside the
+// pool are spread round-robin over small per-worker inboxes, so submitters do not share one lock.
+// Idle workers spin with exponential backoff, then yield, and finally sleep until work arrives.
+class WorkStealingPool {
+public:
+    WorkStealingPool(size_t numThreads) : stop(false), pendingTasks(0), sleepers(0), nextInbox(0) {
+        start_workers(numThreads);
+    }
+
+    template<class F>
+    void enqueue(F&& f) {
+        if (stop.load(std::memory_order_relaxed))
+            throw std::runtime_error("enqueue on stopped WorkStealingPool");
+
+        Task* task = new Task(std::forward<F>(f));
+        pendingTasks.fetch_add(1, std::memory_order_seq_cst);
+        if (currentPool == this) {
+            workers[currentIndex]->deque.push(task);
+        } else {
+            Worker& w = *workers[nextInbox.fetch_add(1, std::memory_order_relaxed) % workers.size()];
+            std::lock_guard<std::mutex> lock(w.inboxMutex);
+            w.inbox.push_back(task);
+        }
+        wake_one();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // True when called from one of this pool's worker threads
+    bool is_worker() const { return currentPool == this; }
+
+    // Runs one pending task on the calling thread, if there is one: a worker looks at its own
+    // deque first, any other thread only steals. Lets a waiting thread help instead of blocking.
+    bool try_run_one() {
+        static thread_local std::minstd_rand rng(std::random_device{}());
+        Task* task = currentPool == this ? find_task(currentIndex, rng) : steal_task(workers.size(), rng);
+        if (!task)
+            return false;
+        run_task(task);
+        return true;
+    }
+
+    // Drains all queued tasks and restarts the pool with numThreads workers.
+    // Must not be called while tasks are still being enqueued.
+    void resize(size_t numThreads) {
+        if (numThreads == workers.size())
+            return;
+        stop_workers();
+        stop = false;
+        start_workers(numThreads);
+    }
+
+    ~WorkStealingPool() {
+        stop_workers();
+    }
+
+private:
+    // Deque slots hold pointers, so every task is one allocation; the callable itself sits inline
+    using Task = InlineTask;
+
+    // Chase-Lev work-stealing deque ("Correct and Efficient Work-Stealing for Weak Memory Models").
+    // push/pop may only be called by the owning worker, steal by any thread.
+    class TaskDeque {
+    public:
+        TaskDeque() : top(0), bottom(0), array(new Array(64)) {
+            retired.emplace_back(array.load(std::memory_order_relaxed));
+        }
+
+        void push(Task* task) {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            Array* a = array.load(std::memory_order_relaxed);
+            if (b - t > a->capacity - 1)
+                a = grow(a, t, b);
+            a->put(b, task);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        Task* pop() {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            Array* a = array.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            Task* task = a->get(b);
+            if (t == b) {
+                // Last element: race against thieves for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    task = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+
+        Task* steal() {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+            Array* a = array.load(std::memory_order_acquire);
+            Task* task = a->get(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return task;
+        }
+
+    private:
+        struct Array {
+            explicit Array(int64_t cap) : capacity(cap), slots(new std::atomic<Task*>[cap]) {}
+            Task* get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+            void put(int64_t i, Task* task) { slots[i & (capacity - 1)].store(task, std::memory_order_relaxed); }
+
+            int64_t capacity;
+            std::unique_ptr<std::atomic<Task*>[]> slots;
+        };
+
+        // Old arrays stay alive until the deque dies, since a thief may still be reading one
+        Array* grow(Array* old, int64_t t, int64_t b) {
+            Array* bigger = new Array(old->capacity * 2);
+            for (int64_t i = t; i < b; ++i)
+                bigger->put(i, old->get(i));
+            retired.emplace_back(bigger);
+            array.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+
+        alignas(cacheLineSize) std::atomic<int64_t> top;
+        alignas(cacheLineSize) std::atomic<int64_t> bottom;
+        std::atomic<Array*> array;
+        std::vector<std::unique_ptr<Array>> retired;
+    };
+
+    struct alignas(cacheLineSize) Worker {
+        TaskDeque deque;
+        std::mutex inboxMutex;
+        std::vector<Task*> inbox;
+        std::thread thread;
+    };
+
+    void start_workers(size_t numThreads) {
+        for (size_t i = 0; i < numThreads; ++i)
+            workers.emplace_back(std::make_unique<Worker>());
+        for (size_t i = 0; i < numThreads; ++i)
+            workers[i]->thread = std::thread([this, i] { worker_loop(i); });
+    }
+
+    void stop_workers() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stop = true;
+        }
+        sleepCv.notify_all();
+        for (auto& worker : workers)
+            worker->thread.join();
+        workers.clear();
+    }
+
+    void wake_one() {
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            sleepCv.notify_one();
+        }
+    }
+
+    // Moves the inbox of worker w into its deque (own inbox) or takes one task from it (victim)
+    Task* take_from_inbox(Worker& w, bool own) {
+        std::unique_lock<std::mutex> lock(w.inboxMutex, std::try_to_lock);
+        if (!lock.owns_lock() || w.inbox.empty())
+            return nullptr;
+        Task* task = w.inbox.back();
+        w.inbox.pop_back();
+        if (own) {
+            for (Task* t : w.inbox)
+                w.deque.push(t);
+            w.inbox.clear();
+        }
+        return task;
+    }
+
+    Task* find_task(size_t index, std::minstd_rand& rng) {
+        Worker& self = *workers[index];
+        if (Task* task = self.deque.pop())
+            return task;
+        if (Task* task = take_from_inbox(self, true))
+            return task;
+        return steal_task(index, rng);
+    }
+
+    // Tries every worker except index once, starting at a random victim
+    Task* steal_task(size_t index, std::minstd_rand& rng) {
+        size_t n = workers.size();
+        size_t first = rng() % n;
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (first + k) % n;
+            if (victim == index)
+                continue;
+            if (Task* task = workers[victim]->deque.steal())
+                return task;
+            if (Task* task = take_from_inbox(*workers[victim], false))
+                return task;
+        }
+        return nullptr;
+    }
+
+    void run_task(Task* task) {
+        pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+        (*task)();
+        delete task;
+    }
+
+    void worker_loop(size_t index) {
+        currentPool = this;
+        pin_current_thread(index);
+        currentIndex = index;
+        std::minstd_rand rng(static_cast<unsigned int>(index + 1));
+        unsigned int idleRounds = 0;
+        // As in CompletionLatch, spinning on a single hardware thread only delays whoever has work
+        const unsigned int spinLimit = std::thread::hardware_concurrency() > 1 ? spinRounds : 0;
+
+        while (true) {
+            if (Task* task = find_task(index, rng)) {
+                run_task(task);
+                idleRounds = 0;
+                continue;
+            }
+
+            if (stop.load(std::memory_order_acquire) && pendingTasks.load(std::memory_order_acquire) == 0)
+                break;
+
+            // Backoff: exponentially longer spins, then yields, then sleep until work arrives
+            ++idleRounds;
+            if (idleRounds <= spinLimit) {
+                for (unsigned int i = 0; i < (1u << idleRounds); ++i)
+                    cpu_relax();
+            } else if (idleRounds <= spinLimit + yieldRounds) {
+                std::this_thread::yield();
+            } else {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                sleepCv.wait(lock, [this] {
+                    return stop.load() || pendingTasks.load(std::memory_order_seq_cst) > 0;
+                });
+                sleepers.fetch_sub(1, std::memory_order_relaxed);
+                idleRounds = 0;
+            }
+        }
+
+        currentPool = nullptr;
+    }
+
+    static constexpr unsigned int spinRounds = 10;
+    static constexpr unsigned int yieldRounds = 16;
+
+    static inline thread_local WorkStealingPool* currentPool = nullptr;
+    static inline thread_local size_t currentIndex = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stop;
+    std::atomic<size_t> pendingTasks;   // enqueued but not yet picked up
+    std::atomic<int> sleepers;
+    std::atomic<size_t> nextInbox;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+};
+
+// Splits the data into numTasks tasks (default: one per pool worker); the pool is owned by the
+// caller and reused. Works with any pool exposing enqueue() and size(), e.g. ThreadPool or
+// WorkStealingPool.
+template<class T, class Acc, class Pool>
+void threadpool_sum(std::span<const T> data, std::atomic<Acc>& total,
+                   Pool& pool, SumKernel kernel = SumKernel::Simd, size_t numTasks = 0,
+                   Schedule schedule = Schedule::Static) {
+    if (numTasks == 0)
+        numTasks = pool.size();
+    numTasks = std::min(numTasks, std::max<size_t>(data.size(), 1));
+    ChunkScheduler scheduler(data.size(), numTasks, schedule);
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+    CompletionLatch latch(numTasks);
+
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.enqueue([data, &total, i, sum, &scheduler, &latch]() {
+            Acc localSum = 0;
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                localSum += sum(data.data() + start, end - start);
+            });
+            atomic_add(total, localSum, std::memory_order_relaxed);
+            latch.count_down();
+        });
+    }
+
+    latch.wait();
+}
+
+// Fused aggregates: sum, min, max and sum of squares in one pass, for any subset of them given as
+// a mask of stat* flags; the count comes for free. Every statistic has its own eight lanes, like
+// the unrolled kernel, so each one adds a vector instruction per block rather than a pass over
+// memory, and the kernels run as their WidestVariant. The sum of squares is kept in double, so
+// that it cannot overflow for integers; with large values of one sign the variance derived from
+// it loses precision.
+constexpr unsigned int statSum = 1, statMin = 2, statMax = 4, statSumSquares = 8;
+constexpr unsigned int allStats = statSum | statMin | statMax | statSumSquares;
+
+inline unsigned int aggregateStats = allStats;   // --stats
+
+constexpr std::pair<unsigned int, const char*> statNames[] = {
+    {statSum, "sum"}, {statMin, "min"}, {statMax, "max"}, {statSumSquares, "sumsq"}};
+
+std::string stats_name(unsigned int stats) {
+    std::string name;
+    for (auto [stat, statName] : statNames) {
+        if (!(stats & stat))
+            continue;
+        if (!name.empty())
+            name += ',';
+        name += statName;
+    }
+    return name;
+}
+
+unsigned int parse_stats(const std::string& list) {
+    unsigned int stats = 0;
+    std::stringstream names(list);
+    for (std::string name; std::getline(names, name, ',');) {
+        auto it = std::find_if(std::begin(statNames), std::end(statNames),
+                               [&](const auto& entry) { return name == entry.second; });
+        if (it == std::end(statNames))
+            throw std::runtime_error("unknown statistic " + zen::quote(name) + ", expected sum, min, max or sumsq");
+        stats |= it->first;
+    }
+    if (stats == 0)
+        throw std::runtime_error("no statistics given");
+    return stats;
+}
+
+template<class T, class Acc = accumulator_t<T>>
+struct Aggregate {
+    static constexpr T noMin = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                                     : std::numeric_limits<T>::max();
+    static constexpr T noMax = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                                     : std::numeric_limits<T>::lowest();
+
+    size_t count = 0;
+    Acc sum = 0;
+    T min = noMin;
+    T max = noMax;
+    double sumSquares = 0;
+
+    void merge(const Aggregate& other) {
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        sumSquares += other.sumSquares;
+    }
+
+    double mean() const { return count ? double(sum) / count : std::numeric_limits<double>::quiet_NaN(); }
+
+    // Sample variance; needs statSum and statSumSquares
+    double variance() const {
+        if (count < 2)
+            return std::numeric_limits<double>::quiet_NaN();
+        return std::max(sumSquares - double(sum) * double(sum) / count, 0.0) / (count - 1);
+    }
+};
+
+template<class T, class Acc, unsigned int Stats, size_t lanes>
+SIMD_INLINE void aggregate_add(Acc (&sums)[lanes], T (&mins)[lanes], T (&maxs)[lanes], double (&squares)[lanes],
+                               size_t k, T x) {
+    if constexpr ((Stats & statSum) != 0)
+        sums[k] += static_cast<Acc>(x);
+    if constexpr ((Stats & statMin) != 0)
+        mins[k] = x < mins[k] ? x : mins[k];
+    if constexpr ((Stats & statMax) != 0)
+        maxs[k] = x > maxs[k] ? x : maxs[k];
+    if constexpr ((Stats & statSumSquares) != 0)
+        squares[k] += double(x) * double(x);
+}
+
+template<class T, class Acc, unsigned int Stats>
+SIMD_INLINE Aggregate<T, Acc> aggregate_kernel(const T* data, size_t count) {
+    using Result = Aggregate<T, Acc>;
+    constexpr size_t lanes = 8;
+    Acc sums[lanes] = {};
+    T mins[lanes], maxs[lanes];
+    double squares[lanes] = {};
+    std::fill_n(mins, lanes, Result::noMin);
+    std::fill_n(maxs, lanes, Result::noMax);
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+        for (size_t k = 0; k < lanes; ++k)
+            aggregate_add<T, Acc, Stats>(sums, mins, maxs, squares, k, data[i + k]);
+    for (; i < count; ++i)
+        aggregate_add<T, Acc, Stats>(sums, mins, maxs, squares, 0, data[i]);
+
+    Result result;
+    result.count = count;
+    for (size_t k = 0; k < lanes; ++k) {
+        result.sum += sums[k];
+        result.min = std::min(result.min, mins[k]);
+        result.max = std::max(result.max, maxs[k]);
+        result.sumSquares += squares[k];
+    }
+    return result;
+}
+
+template<class T, class Acc>
+using AggregateKernelFn = Aggregate<T, Acc> (*)(const T* data, size_t count);
+
+template<class T, class Acc, unsigned int... Stats>
+std::array<AggregateKernelFn<T, Acc>, sizeof...(Stats)> aggregate_kernel_table(std::integer_sequence<unsigned int, Stats...>) {
+    return {WidestVariant<&aggregate_kernel<T, Acc, Stats>>::pick()...};
+}
+
+template<class T, class Acc = accumulator_t<T>>
+AggregateKernelFn<T, Acc> aggregate_kernel_for(unsigned int stats) {
+    static const auto kernels = aggregate_kernel_table<T, Acc>(std::make_integer_sequence<unsigned int, allStats + 1>());
+    return kernels[stats & allStats];
+}
+
+template<class T, class Acc = accumulator_t<T>>
+Aggregate<T, Acc> aggregate(std::span<const T> data, unsigned int stats = allStats) {
+    return aggregate_kernel_for<T, Acc>(stats)(data.data(), data.size());
+}
+
+// Every task aggregates its ranges into its own cache-line-aligned partial, and the partials are
+// merged in task order once all are done
+template<class T, class Acc = accumulator_t<T>, class Pool>
+Aggregate<T, Acc> aggregate(std::span<const T> data, Pool& pool, unsigned int stats = allStats,
+                            Schedule schedule = Schedule::Static) {
+    size_t numTasks = std::min(pool.size(), std::max<size_t>(data.size(), 1));
+    ChunkScheduler scheduler(data.size(), numTasks, schedule);
+    AggregateKernelFn<T, Acc> kernel = aggregate_kernel_for<T, Acc>(stats);
+    std::vector<PaddedSum<Aggregate<T, Acc>>> partials(numTasks);
+    CompletionLatch latch(numTasks);
+
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.enqueue([data, i, kernel, &scheduler, &partials, &latch]() {
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                partials[i].value.merge(kernel(data.data() + start, end - start));
+            });
+            latch.count_down();
+        });
+    }
+    latch.wait();
+
+    Aggregate<T, Acc> result;
+    for (const auto& partial : partials)
+        result.merge(partial.value);
+    return result;
+}
+
+// Predicated sums: only the elements whose mask entry is set are added. A byte mask holds one
+// byte per element, nonzero meaning selected; a bitmap holds bit i % 64 of word i / 64 for
+// element i. Both kernels select with a blend instead of a branch, so their time does not depend
+// on the selectivity, and run as their WidestVariant. The parallel versions split the data with
+// the ChunkScheduler of threadpool_sum.
+// x if selected, else 0, by masking the bits instead of branching
+template<class Acc>
+SIMD_INLINE Acc select_value(bool selected, Acc x) {
+    static_assert(sizeof(Acc) == sizeof(uint64_t));
+    return std::bit_cast<Acc>(std::bit_cast<uint64_t>(x) & (uint64_t(0) - uint64_t(selected)));
+}
+
+template<class T, class Acc>
+SIMD_INLINE Acc byte_mask_sum_kernel(const T* data, const uint8_t* mask, size_t first, size_t count) {
+    constexpr size_t lanes = 8;
+    mask += first;
+    Acc acc[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+        for (size_t k = 0; k < lanes; ++k)
+            acc[k] += select_value(mask[i + k] != 0, static_cast<Acc>(data[i + k]));
+    for (; i < count; ++i)
+        acc[0] += select_value(mask[i] != 0, static_cast<Acc>(data[i]));
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+SIMD_INLINE bool bitmap_selected(const uint64_t* bitmap, size_t i) {
+    return ((bitmap[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+// first is the index of data[0] in the bitmap, so that ranges need not start on a word
+template<class T, class Acc>
+SIMD_INLINE Acc bitmap_sum_kernel(const T* data, const uint64_t* bitmap, size_t first, size_t count) {
+    constexpr size_t lanes = 8;
+    Acc acc[lanes] = {};
+    size_t i = 0;
+    for (; i < count && (first + i) % 64 != 0; ++i)
+        acc[0] += select_value(bitmap_selected(bitmap, first + i), static_cast<Acc>(data[i]));
+    for (; i + 64 <= count; i += 64) {
+        uint64_t word = bitmap[(first + i) / 64];
+        for (size_t g = 0; g < 64; g += lanes)
+            for (size_t k = 0; k < lanes; ++k)
+                acc[k] += select_value(((word >> (g + k)) & 1) != 0, static_cast<Acc>(data[i + g + k]));
+    }
+    for (; i < count; ++i)
+        acc[0] += select_value(bitmap_selected(bitmap, first + i), static_cast<Acc>(data[i]));
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+template<class T, class Acc, class Mask>
+using MaskedSumFn = Acc (*)(const T* data, const Mask* mask, size_t first, size_t count);
+
+template<class T, class Acc, class Mask>
+MaskedSumFn<T, Acc, Mask> masked_sum_kernel() {
+    if constexpr (std::is_same_v<Mask, uint8_t>)
+        return WidestVariant<&byte_mask_sum_kernel<T, Acc>>::pick();
+    else
+        return WidestVariant<&bitmap_sum_kernel<T, Acc>>::pick();
+}
+
+// Number of mask entries needed for count elements
+template<class Mask>
+size_t mask_size(size_t count) {
+    return std::is_same_v<Mask, uint8_t> ? count : (count + 63) / 64;
+}
+
+template<class T, class Acc = accumulator_t<T>, class Mask>
+Acc masked_sum(std::span<const T> data, std::span<const Mask> mask) {
+    if (mask.size() < mask_size<Mask>(data.size()))
+        throw std::runtime_error("mask is shorter than the data");
+    static const MaskedSumFn<T, Acc, Mask> sum = masked_sum_kernel<T, Acc, Mask>();
+    return sum(data.data(), mask.data(), 0, data.size());
+}
+
+template<class T, class Acc = accumulator_t<T>, class Mask, class Pool>
+Acc masked_sum(std::span<const T> data, std::span<const Mask> mask, Pool& pool,
+               Schedule schedule = Schedule::Static) {
+    if (mask.size() < mask_size<Mask>(data.size()))
+        throw std::runtime_error("mask is shorter than the data");
+    static const MaskedSumFn<T, Acc, Mask> sum = masked_sum_kernel<T, Acc, Mask>();
+    size_t numTasks = std::min(pool.size(), std::max<size_t>(data.size(), 1));
+    ChunkScheduler scheduler(data.size(), numTasks, schedule);
+    std::vector<PaddedSum<Acc>> partials(numTasks);
+    CompletionLatch latch(numTasks);
+
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.enqueue([data, mask, i, &scheduler, &partials, &latch]() {
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                partials[i].value += sum(data.data() + start, mask.data(), start, end - start);
+            });
+            latch.count_down();
+        });
+    }
+    latch.wait();
+
+    Acc total = 0;
+    for (const auto& partial : partials)
+        total += partial.value;
+    return total;
+}
+
+// Group-by sum: the sum and count of the elements of every distinct key, in key order. How the
+// groups are tabled depends on numKeys, the bound on the keys if the caller knows one:
+//   Direct:      numKeys groups fit in groupDirectBytes, about a per-core L2. Every task adds
+//                into a directly indexed table of its own, and the tables are added up.
+//   Partitioned: more keys than that. Every task first scatters its (key, value) pairs into
+//                one bucket per range of groupPartitionKeys keys, then every task takes whole
+//                partitions and adds their buckets into one direct table of that size, so both
+//                passes stay within the cache however many keys there are.
+//   Hash:        no bound given. Every task keeps an open-addressing hash table that grows as it
+//                meets new keys, and the tables are merged by key.
+// The tasks split the data with the ChunkScheduler of threadpool_sum, and partials are always
+// combined in task order. Keys not below numKeys throw.
+constexpr size_t groupDirectBytes = size_t(256) << 10;
+constexpr size_t groupHashCapacity = 1024;
+
+enum class GroupTable { Direct, Partitioned, Hash };
+
+const char* to_string(GroupTable table) {
+    switch (table) {
+    case GroupTable::Direct:      return "direct";
+    case GroupTable::Partitioned: return "partitioned";
+    case GroupTable::Hash:        return "hash";
+    }
+    return "unknown";
+}
+
+template<class Acc>
+constexpr size_t groupPartitionKeys = std::bit_floor(groupDirectBytes / (sizeof(Acc) + sizeof(size_t)));
+
+template<class Acc>
+GroupTable group_table_for(size_t numKeys) {
+    if (numKeys == 0)
+        return GroupTable::Hash;
+    return numKeys <= groupPartitionKeys<Acc> ? GroupTable::Direct : GroupTable::Partitioned;
+}
+
+template<class Acc>
+struct GroupSum {
+    uint32_t key = 0;
+    Acc sum = 0;
+    size_t count = 0;
+};
+
+template<class Acc>
+class GroupHashTable {
+public:
+    void add(uint32_t key, Acc value) {
+        if (2 * (size + 1) > slots.size())
+            grow();
+        size_t mask = slots.size() - 1;
+        uint64_t tag = uint64_t(key) + 1;   // 0 marks an empty slot
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.tag == tag) {
+                slot.sum += value;
+                ++slot.count;
+                return;
+            }
+            if (slot.tag == 0) {
+                slot = {tag, value, 1};
+                ++size;
+                return;
+            }
+        }
+    }
+
+    template<class Func>
+    void for_each(Func&& func) const {
+        for (const Slot& slot : slots)
+            if (slot.tag != 0)
+                func(GroupSum<Acc>{static_cast<uint32_t>(slot.tag - 1), slot.sum, slot.count});
+    }
+
+private:
+    struct Slot {
+        uint64_t tag = 0;
+        Acc sum = 0;
+        size_t count = 0;
+    };
+
+    static size_t hash(uint32_t key) { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32); }
+
+    void grow() {
+        std::vector<Slot> old(std::max(2 * slots.size(), groupHashCapacity));
+        old.swap(slots);
+        size = 0;
+        for (const Slot& slot : old) {
+            if (slot.tag == 0)
+                continue;
+            size_t mask = slots.size() - 1;
+            size_t i = hash(static_cast<uint32_t>(slot.tag - 1)) & mask;
+            while (slots[i].tag != 0)
+                i = (i + 1) & mask;
+            slots[i] = slot;
+            ++size;
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t size = 0;
+};
+
+// Directly indexed sums and counts of the keys [base, base + size)
+template<class Acc>
+struct DirectGroupTable {
+    DirectGroupTable(uint32_t base, size_t size) : base(base), sums(size, Acc(0)), counts(size, 0) {}
+
+    void add(uint32_t key, Acc value) {
+        sums[key - base] += value;
+        ++counts[key - base];
+    }
+
+    void append_groups(std::vector<GroupSum<Acc>>& groups) const {
+        for (size_t k = 0; k < sums.size(); ++k)
+            if (counts[k] > 0)
+                groups.push_back({static_cast<uint32_t>(base + k), sums[k], counts[k]});
+    }
+
+    uint32_t base;
+    std::vector<Acc> sums;
+    std::vector<size_t> counts;
+};
+
+template<class T, class Acc = accumulator_t<T>, class Pool>
+std::vector<GroupSum<Acc>> group_sum(std::span<const T> data, std::span<const uint32_t> keys, Pool& pool,
+                                     size_t numKeys = 0, Schedule schedule = Schedule::Static) {
+    if (keys.size() < data.size())
+        throw std::runtime_error("fewer keys than elements");
+    if (numKeys > size_t(std::numeric_limits<uint32_t>::max()) + 1)
+        throw std::runtime_error("numKeys exceeds the 32-bit key range");
+    size_t numTasks = std::min(pool.size(), std::max<size_t>(data.size(), 1));
+    ChunkScheduler scheduler(data.size(), numTasks, schedule);
+    std::atomic<bool> outOfRange(false);
+    std::vector<GroupSum<Acc>> groups;
+
+    auto run_tasks = [&](auto&& body) {
+        CompletionLatch latch(numTasks);
+        for (size_t i = 0; i < numTasks; ++i) {
+            pool.enqueue([&body, &latch, i]() {
+                body(i);
+                latch.count_down();
+            });
+        }
+        latch.wait();
+    };
+    auto check_keys = [&]() {
+        if (outOfRange.load())
+            throw std::runtime_error("group key out of range for " + std::to_string(numKeys) + " keys");
+    };
+
+    switch (group_table_for<Acc>(numKeys)) {
+    case GroupTable::Direct: {
+        std::vector<std::optional<DirectGroupTable<Acc>>> tables(numTasks);
+        run_tasks([&](size_t i) {
+            DirectGroupTable<Acc>& table = tables[i].emplace(0, numKeys);
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                for (size_t j = start; j < end; ++j) {
+                    if (keys[j] >= numKeys) {
+                        outOfRange.store(true, std::memory_order_relaxed);
+                        continue;
+                    }
+                    table.add(keys[j], static_cast<Acc>(data[j]));
+                }
+            });
+        });
+        check_keys();
+        DirectGroupTable<Acc>& total = *tables[0];
+        for (size_t i = 1; i < numTasks; ++i) {
+            for (size_t k = 0; k < numKeys; ++k) {
+                total.sums[k] += tables[i]->sums[k];
+                total.counts[k] += tables[i]->counts[k];
+            }
+        }
+        total.append_groups(groups);
+        return groups;
+    }
+
+    case GroupTable::Partitioned: {
+        struct Entry {
+            uint32_t key;
+            T value;
+        };
+        constexpr size_t partitionKeys = groupPartitionKeys<Acc>;
+        size_t numPartitions = (numKeys + partitionKeys - 1) / partitionKeys;
+        std::vector<std::vector<std::vector<Entry>>> buckets(numTasks);
+        run_tasks([&](size_t i) {
+            auto& local = buckets[i];
+            local.resize(numPartitions);
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                for (size_t j = start; j < end; ++j) {
+                    if (keys[j] >= numKeys) {
+                        outOfRange.store(true, std::memory_order_relaxed);
+                        continue;
+                    }
+                    local[keys[j] / partitionKeys].push_back({keys[j], data[j]});
+                }
+            });
+        });
+        check_keys();
+
+        std::vector<std::vector<GroupSum<Acc>>> partitionGroups(numPartitions);
+        run_tasks([&](size_t i) {
+            for (size_t p = i; p < numPartitions; p += numTasks) {
+                uint32_t base = static_cast<uint32_t>(p * partitionKeys);
+                DirectGroupTable<Acc> table(base, std::min(partitionKeys, numKeys - base));
+                for (const auto& local : buckets)
+                    for (const Entry& entry : local[p])
+                        table.add(entry.key, static_cast<Acc>(entry.value));
+                table.append_groups(partitionGroups[p]);
+            }
+        });
+        for (const auto& partition : partitionGroups)
+            groups.insert(groups.end(), partition.begin(), partition.end());
+        return groups;
+    }
+
+    case GroupTable::Hash:
+        break;
+    }
+
+    std::vector<GroupHashTable<Acc>> tables(numTasks);
+    run_tasks([&](size_t i) {
+        scheduler.for_each_range(i, [&](size_t start, size_t end) {
+            for (size_t j = start; j < end; ++j)
+                tables[i].add(keys[j], static_cast<Acc>(data[j]));
+        });
+    });
+
+    // Stable, so that equal keys are added in task order
+    for (const auto& table : tables)
+        table.for_each([&](const GroupSum<Acc>& group) { groups.push_back(group); });
+    std::stable_sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+    size_t merged = 0;
+    for (size_t i = 0; i < groups.size(); ++i) {
+        if (merged > 0 && groups[merged - 1].key == groups[i].key) {
+            groups[merged - 1].sum += groups[i].sum;
+            groups[merged - 1].count += groups[i].count;
+        } else {
+            groups[merged++] = groups[i];
+        }
+    }
+    groups.resize(merged);
+    return groups;
+}
+
+// Accumulator policies for integer sums, chosen at compile time as the Policy of policy_sum:
+//   WrapPolicy:       the accumulator_t sum of the other methods, which wraps on overflow
+//   CheckedPolicy:    the exact sum, throwing SumOverflow if it does not fit accumulator_t
+//   SaturatingPolicy: the exact sum, clamped to the range of accumulator_t
+//   WidePolicy:       the exact sum as an Int128
+// The last three share exact_sum. Elements narrower than 64 bits cannot overflow a 64-bit
+// block sum, so their blocks go through the plain sum kernel. int64 blocks are summed in
+// wrapping lanes that also flag, by the sign rule, whether any lane overflowed; only flagged
+// blocks are summed again in 128-bit lanes. Block sums are added in 128 bits.
+constexpr size_t checkedBlockSize = 65536;
+
+class SumOverflow : public std::runtime_error {
+public:
+    SumOverflow() : std::runtime_error("integer sum overflows its accumulator") {}
+};
+
+// Signed 128-bit integer as two 64-bit halves, with just what exact sums need
+struct Int128 {
+    uint64_t lo = 0;
+    int64_t hi = 0;
+
+    Int128() = default;
+    Int128(uint64_t lo, int64_t hi) : lo(lo), hi(hi) {}
+    Int128(int value) : Int128(static_cast<long long>(value)) {}
+    Int128(long long value) : lo(static_cast<uint64_t>(value)), hi(value < 0 ? -1 : 0) {}
+    Int128(unsigned long long value) : lo(value), hi(0) {}
+
+    Int128& operator+=(const Int128& other) {
+        uint64_t sum = lo + other.lo;
+        hi = static_cast<int64_t>(uint64_t(hi) + uint64_t(other.hi) + (sum < lo));
+        lo = sum;
+        return *this;
+    }
+
+    template<class Int>
+    bool fits() const {
+        if constexpr (std::is_signed_v<Int>)
+            return hi == (static_cast<int64_t>(lo) < 0 ? -1 : 0);
+        else
+            return hi == 0;
+    }
+
+    double to_double() const { return std::ldexp(static_cast<double>(hi), 64) + static_cast<double>(lo); }
+};
+
+std::string to_string(const Int128& value) {
+    bool negative = value.hi < 0;
+    uint64_t lo = value.lo, hi = static_cast<uint64_t>(value.hi);
+    if (negative) {
+        lo = ~lo + 1;
+        hi = ~hi + (lo == 0);
+    }
+    uint32_t limbs[4] = {uint32_t(hi >> 32), uint32_t(hi), uint32_t(lo >> 32), uint32_t(lo)};
+    std::string digits;
+    do {
+        uint64_t remainder = 0;
+        for (uint32_t& limb : limbs) {
+            uint64_t current = (remainder << 32) | limb;
+            limb = static_cast<uint32_t>(current / 10);
+            remainder = current % 10;
+        }
+        digits += static_cast<char>('0' + remainder);
+    } while (limbs[0] | limbs[1] | limbs[2] | limbs[3]);
+    if (negative)
+        digits += '-';
+    return {digits.rbegin(), digits.rend()};
+}
+
+std::ostream& operator<<(std::ostream& out, const Int128& value) {
+    return out << to_string(value);
+}
+
+// Sum in 128-bit lanes: every lane carries its low half into its high half
+SIMD_INLINE void wide_add(uint64_t& lo, uint64_t& hi, int64_t x) {
+    uint64_t sum = lo + static_cast<uint64_t>(x);
+    hi += static_cast<uint64_t>(x >> 63) + (sum < lo);
+    lo = sum;
+}
+
+// Elements are sign-extended into the lanes, so 64-bit element types must be signed
+template<class T>
+SIMD_INLINE Int128 wide_sum_kernel(const T* data, size_t count) {
+    static_assert(std::is_signed_v<T> || sizeof(T) < sizeof(int64_t),
+                  "uint64_t does not fit in int64_t lanes");
+    constexpr size_t lanes = 8;
+    uint64_t lo[lanes] = {}, hi[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+        for (size_t k = 0; k < lanes; ++k)
+            wide_add(lo[k], hi[k], static_cast<int64_t>(data[i + k]));
+    for (; i < count; ++i)
+        wide_add(lo[0], hi[0], static_cast<int64_t>(data[i]));
+    Int128 sum;
+    for (size_t k = 0; k < lanes; ++k)
+        sum += Int128(lo[k], static_cast<int64_t>(hi[k]));
+    return sum;
+}
+
+struct FlaggedSum {
+    Int128 sum;
+    bool overflowed;
+};
+
+// Sum in wrapping 64-bit lanes; a lane overflowed when both operands of an add have one sign
+// and the result the other
+SIMD_INLINE void flagged_add(uint64_t& sum, uint64_t& flag, int64_t x) {
+    uint64_t next = sum + static_cast<uint64_t>(x);
+    flag |= ~(sum ^ static_cast<uint64_t>(x)) & (sum ^ next);
+    sum = next;
+}
+
+template<class T>
+SIMD_INLINE FlaggedSum flagged_sum_kernel(const T* data, size_t count) {
+    static_assert(std::is_signed_v<T> || sizeof(T) < sizeof(int64_t),
+                  "uint64_t does not fit in int64_t lanes");
+    constexpr size_t lanes = 8;
+    uint64_t sums[lanes] = {}, flags[lanes] = {};
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+        for (size_t k = 0; k < lanes; ++k)
+            flagged_add(sums[k], flags[k], static_cast<int64_t>(data[i + k]));
+    for (; i < count; ++i)
+        flagged_add(sums[0], flags[0], static_cast<int64_t>(data[i]));
+    FlaggedSum result{Int128(), false};
+    uint64_t flag = 0;
+    for (size_t k = 0; k < lanes; ++k) {
+        result.sum += Int128(static_cast<long long>(sums[k]));
+        flag |= flags[k];
+    }
+    result.overflowed = (flag >> 63) != 0;
+    return result;
+}
+
+template<class T>
+Int128 exact_sum(const T* data, size_t count) {
+    static_assert(std::is_integral_v<T>, "exact sums need an integer element type");
+    static_assert(std::is_signed_v<T> || sizeof(T) < sizeof(int64_t),
+                  "exact sums of uint64_t are not supported");
+    Int128 total;
+    if constexpr (sizeof(T) < sizeof(int64_t)) {
+        // 2^31 elements of under 32 bits stay below 2^63
+        using Acc = accumulator_t<T>;
+        SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(SumKernel::Simd);
+        for (size_t i = 0; i < count; i += size_t(1) << 31)
+            total += Int128(sum(data + i, std::min(size_t(1) << 31, count - i)));
+    } else {
+        static const auto flagged = WidestVariant<&flagged_sum_kernel<T>>::pick();
+        static const auto wide = WidestVariant<&wide_sum_kernel<T>>::pick();
+        for (size_t i = 0; i < count; i += checkedBlockSize) {
+            size_t blockCount = std::min(checkedBlockSize, count - i);
+            FlaggedSum block = flagged(data + i, blockCount);
+            total += block.overflowed ? wide(data + i, blockCount) : block.sum;
+        }
+    }
+    return total;
+}
+
+struct WrapPolicy {
+    template<class T> using partial_type = accumulator_t<T>;
+    template<class T> using result_type = accumulator_t<T>;
+
+    template<class T>
+    static partial_type<T> sum(const T* data, size_t count) {
+        return sum_kernel<T, accumulator_t<T>>(SumKernel::Simd)(data, count);
+    }
+
+    template<class T>
+    static result_type<T> finish(partial_type<T> total) { return total; }
+};
+
+struct CheckedPolicy {
+    template<class T> using partial_type = Int128;
+    template<class T> using result_type = accumulator_t<T>;
+
+    template<class T>
+    static Int128 sum(const T* data, size_t count) { return exact_sum(data, count); }
+
+    template<class T>
+    static result_type<T> finish(const Int128& total) {
+        if (!total.fits<result_type<T>>())
+            throw SumOverflow();
+        return static_cast<result_type<T>>(total.lo);
+    }
+};
+
+struct SaturatingPolicy {
+    template<class T> using partial_type = Int128;
+    template<class T> using result_type = accumulator_t<T>;
+
+    template<class T>
+    static Int128 sum(const T* data, size_t count) { return exact_sum(data, count); }
+
+    template<class T>
+    static result_type<T> finish(const Int128& total) {
+        using Acc = result_type<T>;
+        if (!total.fits<Acc>())
+            return total.hi < 0 ? std::numeric_limits<Acc>::min() : std::numeric_limits<Acc>::max();
+        return static_cast<Acc>(total.lo);
+    }
+};
+
+struct WidePolicy {
+    template<class T> using partial_type = Int128;
+    template<class T> using result_type = Int128;
+
+    template<class T>
+    static Int128 sum(const T* data, size_t count) { return exact_sum(data, count); }
+
+    template<class T>
+    static Int128 finish(const Int128& total) { return total; }
+};
+
+template<class Policy, class T>
+typename Policy::template result_type<T> policy_sum(std::span<const T> data) {
+    return Policy::template finish<T>(Policy::sum(data.data(), data.size()));
+}
+
+// Every task sums its ranges into its own padded partial; partials are added in task order and
+// the policy finishes the total on the calling thread, which is where SumOverflow is thrown
+template<class Policy, class T, class Pool>
+typename Policy::template result_type<T> policy_sum(std::span<const T> data, Pool& pool,
+                                                    Schedule schedule = Schedule::Static) {
+    using Partial = typename Policy::template partial_type<T>;
+    size_t numTasks = std::min(pool.size(), std::max<size_t>(data.size(), 1));
+    ChunkScheduler scheduler(data.size(), numTasks, schedule);
+    std::vector<PaddedSum<Partial>> partials(numTasks);
+    CompletionLatch latch(numTasks);
+
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.enqueue([data, i, &scheduler, &partials, &latch]() {
+            scheduler.for_each_range(i, [&](size_t start, size_t end) {
+                partials[i].value += Policy::sum(data.data() + start, end - start);
+            });
+            latch.count_down();
+        });
+    }
+    latch.wait();
+
+    Partial total{};
+    for (const auto& partial : partials)
+        total += partial.value;
+    return Policy::template finish<T>(total);
+}
+
+// Deterministic reduction: the input is cut into fixed blocks of blockSize elements no matter how
+// many threads run, every block is summed on its own, and the block sums are combined in a fixed
+// pairwise tree. Which worker sums which block does not change the result, so the same input
+// gives the same bits on 1 or 128 threads.
+constexpr size_t deterministicBlockSize = 65536;
+
+template<class Acc>
+Acc combine_tree(std::vector<Acc>& values) {
+    if (values.empty())
+        return Acc(0);
+    for (size_t width = values.size(); width > 1; width = (width + 1) / 2) {
+        for (size_t i = 0; i < width / 2; ++i)
+            values[i] = values[2 * i] + values[2 * i + 1];
+        if (width % 2)
+            values[width / 2] = values[width - 1];
+    }
+    return values[0];
+}
+
+template<class T, class Acc = accumulator_t<T>, class Pool>
+Acc deterministic_sum(std::span<const T> data, Pool& pool, SumKernel kernel = SumKernel::Simd,
+                      size_t blockSize = deterministicBlockSize) {
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    std::vector<Acc> blockSums(numBlocks);
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+
+    // One task per worker, each summing a contiguous run of whole blocks
+    size_t numTasks = std::min(pool.size(), std::max<size_t>(numBlocks, 1));
+    size_t blocksPerTask = numBlocks / numTasks;
+    CompletionLatch latch(numTasks);
+
+    for (size_t i = 0; i < numTasks; ++i) {
+        size_t firstBlock = i * blocksPerTask;
+        size_t lastBlock = (i == numTasks - 1) ? numBlocks : firstBlock + blocksPerTask;
+
+        pool.enqueue([data, &blockSums, sum, blockSize, firstBlock, lastBlock, &latch]() {
+            for (size_t b = firstBlock; b < lastBlock; ++b) {
+                size_t start = b * blockSize;
+                blockSums[b] = sum(data.data() + start, std::min(blockSize, data.size() - start));
+            }
+            latch.count_down();
+        });
+    }
+    latch.wait();
+
+    return combine_tree(blockSums);
+}
+
+// Parallel prefix sum with the same static partitioning as the other methods, in two passes over
+// the pool: every chunk is reduced with the summation kernel, the chunk totals are scanned into
+// chunk offsets, then every chunk is scanned into out starting from its offset. Returns the total.
+enum class ScanKind { Inclusive, Exclusive };
+
+const char* to_string(ScanKind kind) {
+    return kind == ScanKind::Inclusive ? "inclusive" : "exclusive";
+}
+
+template<bool Exclusive, class T, class Acc>
+Acc scalar_scan_kernel(const T* data, Acc* out, size_t count, Acc carry) {
+    for (size_t i = 0; i < count; ++i) {
+        Acc next = carry + Acc(data[i]);
+        out[i] = Exclusive ? carry : next;
+        carry = next;
+    }
+    return carry;
+}
+
+// Groups of four are scanned locally and then offset by the carry, so the loop-carried
+// dependency is one add per group instead of one per element, and the in-group adds of
+// consecutive groups overlap
+template<bool Exclusive, class T, class Acc>
+Acc unrolled_scan_kernel(const T* data, Acc* out, size_t count, Acc carry) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Acc a0 = Acc(data[i]);
+        Acc a1 = a0 + Acc(data[i + 1]);
+        Acc a2 = a1 + Acc(data[i + 2]);
+        Acc a3 = a2 + Acc(data[i + 3]);
+        if constexpr (Exclusive) {
+            out[i] = carry;
+            out[i + 1] = carry + a0;
+            out[i + 2] = carry + a1;
+            out[i + 3] = carry + a2;
+        } else {
+            out[i] = carry + a0;
+            out[i + 1] = carry + a1;
+            out[i + 2] = carry + a2;
+            out[i + 3] = carry + a3;
+        }
+        carry += a3;
+    }
+    return scalar_scan_kernel<Exclusive>(data + i, out + i, count - i, carry);
+}
+
+// The scan pass has no compensated variant: every kernel but Scalar uses the unrolled scan
+template<class T, class Acc>
+Acc scan_chunk(const T* data, Acc* out, size_t count, Acc carry, ScanKind kind, SumKernel kernel) {
+    bool exclusive = kind == ScanKind::Exclusive;
+    if (kernel == SumKernel::Scalar)
+        return exclusive ? scalar_scan_kernel<true>(data, out, count, carry)
+                         : scalar_scan_kernel<false>(data, out, count, carry);
+    return exclusive ? unrolled_scan_kernel<true>(data, out, count, carry)
+                     : unrolled_scan_kernel<false>(data, out, count, carry);
+}
+
+template<class T, class Acc, class Pool>
+Acc scan_sum(std::span<const T> data, std::span<Acc> out, Pool& pool,
+             ScanKind kind = ScanKind::Inclusive, SumKernel kernel = SumKernel::Simd) {
+    if (out.size() < data.size())
+        throw std::runtime_error("scan_sum output is shorter than its input");
+
+    size_t numChunks = std::min(pool.size(), std::max<size_t>(data.size(), 1));
+    size_t chunk = data.size() / numChunks;
+    auto chunk_start = [chunk](size_t i) { return i * chunk; };
+    auto chunk_end = [chunk, numChunks, &data](size_t i) {
+        return i == numChunks - 1 ? data.size() : (i + 1) * chunk;
+    };
+
+    // One task per chunk, waited for as a whole
+    auto for_each_chunk = [&pool, numChunks](auto body) {
+        CompletionLatch latch(numChunks);
+        for (size_t i = 0; i < numChunks; ++i) {
+            pool.enqueue([i, &body, &latch]() {
+                body(i);
+                latch.count_down();
+            });
+        }
+        latch.wait();
+    };
+
+    // A single chunk has no offsets to find
+    if (numChunks == 1)
+        return scan_chunk(data.data(), out.data(), data.size(), Acc(0), kind, kernel);
+
+    std::vector<Acc> offsets(numChunks);
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+    for_each_chunk([&](size_t i) {
+        offsets[i] = sum(data.data() + chunk_start(i), chunk_end(i) - chunk_start(i));
+    });
+
+    Acc total = Acc(0);
+    for (auto& offset : offsets) {
+        Acc chunkTotal = offset;
+        offset = total;
+        total += chunkTotal;
+    }
+
+    for_each_chunk([&](size_t i) {
+        scan_chunk(data.data() + chunk_start(i), out.data() + chunk_start(i),
+                   chunk_end(i) - chunk_start(i), offsets[i], kind, kernel);
+    });
+    return total;
+}
+
+// Sums many independent arrays in one dispatch. Arrays are packed in order into tasks of about
+// taskCost elements each, counting batchArrayCost extra per array for the per-call overhead; an
+// array longer than taskCost is split over several tasks. Returns one total per array, combined
+// in a fixed order, and runs on the calling thread when everything fits in one task.
+constexpr size_t batchTaskCost = 256 * 1024;
+constexpr size_t batchArrayCost = 64;
+
+template<class T, class Acc = accumulator_t<T>, class Pool>
+std::vector<Acc> sum_batch(std::span<const std::span<const T>> arrays, Pool& pool,
+                           SumKernel kernel = SumKernel::Simd, size_t taskCost = batchTaskCost) {
+    struct Segment {
+        size_t array;
+        size_t start, end;
+    };
+    std::vector<Segment> segments;
+    std::vector<size_t> taskStarts = {0};  // first segment of every task
+    size_t cost = 0;
+    for (size_t a = 0; a < arrays.size(); ++a) {
+        size_t length = arrays[a].size();
+        for (size_t start = 0;; start += taskCost) {
+            size_t end = std::min(length, start + taskCost);
+            size_t segmentCost = end - start + batchArrayCost;
+            if (cost > 0 && cost + segmentCost > taskCost) {
+                taskStarts.push_back(segments.size());
+                cost = 0;
+            }
+            segments.push_back({a, start, end});
+            cost += segmentCost;
+            if (end == length)
+                break;
+        }
+    }
+    taskStarts.push_back(segments.size());
+    size_t numTasks = taskStarts.size() - 1;
+
+    std::vector<Acc> partials(segments.size());
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+    auto run_task = [&](size_t task) {
+        for (size_t s = taskStarts[task]; s < taskStarts[task + 1]; ++s) {
+            const Segment& segment = segments[s];
+            partials[s] = sum(arrays[segment.array].data() + segment.start, segment.end - segment.start);
+        }
+    };
+
+    if (numTasks == 1) {
+        run_task(0);
+    } else {
+        CompletionLatch latch(numTasks);
+        for (size_t task = 0; task < numTasks; ++task) {
+            pool.enqueue([task, &run_task, &latch]() {
+                run_task(task);
+                latch.count_down();
+            });
+        }
+        latch.wait();
+    }
+
+    std::vector<Acc> totals(arrays.size(), Acc(0));
+    for (size_t s = 0; s < segments.size(); ++s)
+        totals[segments[s].array] += partials[s];
+    return totals;
+}
+
+// Streaming sum for input that arrives incrementally (pipes, sockets, decompressors). The calling
+// thread is the reader stage: it fills buffers taken from a bounded pool of numBuffers, each
+// chunkElements long, and hands every filled buffer to the pool, whose workers sum it while the
+// next one is read. Memory use is bounded by the buffer pool whatever the input size. Chunk sums
+// are combined in a fixed tree, so the result does not depend on the thread count.
+constexpr size_t streamChunkBytes = size_t(1) << 20;
+
+// Where the time of each stage went
+struct StreamStats {
+    size_t bytes = 0;
+    size_t chunks = 0;
+    double readMs = 0;          // reader inside read calls
+    double readerStallMs = 0;   // reader waiting for a free buffer: compute-bound
+    double computeStallMs = 0;  // no buffer being summed, workers waiting for the reader: I/O-bound
+};
+
+template<class T, class Acc = accumulator_t<T>, class Pool>
+Acc stream_sum(std::istream& in, Pool& pool, size_t chunkElements = streamChunkBytes / sizeof(T),
+               size_t numBuffers = 0, SumKernel kernel = SumKernel::Simd, StreamStats* stats = nullptr) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsed_ms = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    if (numBuffers == 0)
+        numBuffers = pool.size() + 1;
+    numBuffers = std::max<size_t>(numBuffers, 2);
+    chunkElements = std::max<size_t>(chunkElements, 1);
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+
+    std::vector<std::unique_ptr<T[]>> buffers(numBuffers);
+    std::vector<T*> freeBuffers;
+    for (auto& buffer : buffers) {
+        buffer.reset(new T[chunkElements]);
+        freeBuffers.push_back(buffer.get());
+    }
+
+    StreamStats local;
+    std::vector<Acc> chunkSums;
+    size_t inFlight = 0;
+    Clock::time_point idleSince = Clock::now();
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Bytes of an element split across two reads, carried over to the next buffer
+    char carry[sizeof(T)];
+    size_t carryBytes = 0;
+    const size_t chunkBytes = chunkElements * sizeof(T);
+
+    while (in) {
+        T* buffer;
+        {
+            auto waitStart = Clock::now();
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&freeBuffers]() { return !freeBuffers.empty(); });
+            local.readerStallMs += elapsed_ms(waitStart, Clock::now());
+            buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+        }
+
+        char* bytes = reinterpret_cast<char*>(buffer);
+        std::memcpy(bytes, carry, carryBytes);
+        size_t filled = carryBytes;
+        auto readStart = Clock::now();
+        while (filled < chunkBytes && in) {
+            in.read(bytes + filled, static_cast<std::streamsize>(chunkBytes - filled));
+            filled += static_cast<size_t>(in.gcount());
+        }
+        local.readMs += elapsed_ms(readStart, Clock::now());
+        local.bytes += filled - carryBytes;
+
+        size_t count = filled / sizeof(T);
+        carryBytes = filled % sizeof(T);
+        std::memcpy(carry, bytes + count * sizeof(T), carryBytes);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == 0) {
+            freeBuffers.push_back(buffer);
+            break;
+        }
+        if (inFlight++ == 0)
+            local.computeStallMs += elapsed_ms(idleSince, Clock::now());
+        size_t index = chunkSums.size();
+        chunkSums.push_back(Acc(0));
+
+        pool.enqueue([buffer, count, index, sum, &chunkSums, &freeBuffers, &inFlight, &idleSince, &mutex, &cv]() {
+            Acc chunkSum = sum(buffer, count);
+
+            // Notify under the lock, as the reader destroys cv once the last buffer is back
+            std::lock_guard<std::mutex> lock(mutex);
+            chunkSums[index] = chunkSum;
+            freeBuffers.push_back(buffer);
+            if (--inFlight == 0)
+                idleSince = Clock::now();
+            cv.notify_one();
+        });
+    }
+
+    // Drain: every buffer back in the pool means every chunk has been summed
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&freeBuffers, numBuffers]() { return freeBuffers.size() == numBuffers; });
+    lock.unlock();
+
+    local.chunks = chunkSums.size();
+    if (stats)
+        *stats = local;
+    return combine_tree(chunkSums);
+}
+
+// Fork-join reduction over [start, end) on a pool. Ranges longer than grain are split in half:
+// the left half becomes a pool task, the right half is reduced by the calling worker, which then
+// runs other pending pool tasks until the left half is done (help-while-waiting join), so no
+// worker ever blocks and recursion never creates threads. A thread outside the pool hands the
+// whole reduction to the pool and waits for it, so it never nests stolen subtrees on its stack.
+// leaf(start, end) reduces a subrange of at most grain indices, op(a, b) combines two results.
+template<class Pool, class T, class Leaf, class Op>
+T parallel_reduce(Pool& pool, size_t start, size_t end, size_t grain, T identity, Leaf leaf, Op op) {
+    if (start >= end)
+        return identity;
+    size_t length = end - start;
+    if (length <= std::max<size_t>(grain, 1))
+        return leaf(start, end);
+
+    if (!pool.is_worker()) {
+        T result = identity;
+        CompletionLatch latch(1);
+        pool.enqueue([&]() {
+            result = parallel_reduce(pool, start, end, grain, identity, leaf, op);
+            latch.count_down();
+        });
+        latch.wait();
+        return result;
+    }
+
+    size_t mid = start + length / 2;
+    T leftResult = identity;
+    std::atomic<bool> leftDone(false);
+    pool.enqueue([&pool, start, mid, grain, &identity, &leaf, &op, &leftResult, &leftDone]() {
+        leftResult = parallel_reduce(pool, start, mid, grain, identity, leaf, op);
+        leftDone.store(true, std::memory_order_release);
+    });
+
+    T rightResult = parallel_reduce(pool, mid, end, grain, identity, leaf, op);
+
+    while (!leftDone.load(std::memory_order_acquire)) {
+        if (!pool.try_run_one())
+            std::this_thread::yield();
+    }
+    return op(leftResult, rightResult);
+}
+
+// Divide-and-conquer sum on a pool; min_per_task is the grain size of parallel_reduce
+template<class T, class Acc = accumulator_t<T>, class Pool>
+Acc fork_join_sum(std::span<const T> data, size_t start, size_t end, Pool& pool,
+                  unsigned int min_per_task = 100000, SumKernel kernel = SumKernel::Simd) {
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(kernel);
+    return parallel_reduce(pool, start, end, min_per_task, Acc(0),
+        [data, sum](size_t first, size_t last) { return sum(data.data() + first, last - first); },
+        [](Acc a, Acc b) { return a + b; });
+}
+
+// Task-based sum using std::async
+template<class T, class Acc = accumulator_t<T>>
+Acc async_sum(std::span<const T> data, size_t start, size_t end, unsigned int min_per_task = 100000,
+              SumKernel kernel = SumKernel::Simd) {
+    size_t length = end - start;
+    if (length <= min_per_task) {
+        return sum_kernel<T, Acc>(kernel)(data.data() + start, length);
+    } else {
+        size_t mid = start + length / 2;
+        auto left = std::async(std::launch::async, async_sum<T, Acc>, data, start, mid, min_per_task, kernel);
+        Acc right_sum = async_sum<T, Acc>(data, mid, end, min_per_task, kernel);
+        return left.get() + right_sum;
+    }
+}
+
+// Coroutine API. sum_async returns a lazy AsyncTask that a coroutine co_awaits instead of
+// blocking a thread on a future: awaiting it dispatches one chunk task per pool worker and
+// suspends, and the last chunk to finish resumes the awaiting coroutine on that pool thread.
+// A stop request on the token makes the chunks that have not finished skip the rest of their
+// data, checked every asyncCancelBlock elements, and the co_await then throws SumCancelled.
+constexpr size_t asyncCancelBlock = 65536;
+
+class SumCancelled : public std::runtime_error {
+public:
+    SumCancelled() : std::runtime_error("sum_async cancelled") {}
+};
+
+template<class R>
+class AsyncTask {
+public:
+    struct promise_type {
+        std::optional<R> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        AsyncTask get_return_object() {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Hands control straight to the awaiting coroutine, without growing the stack
+        auto final_suspend() noexcept {
+            struct Transfer {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    auto continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return Transfer{};
+        }
+
+        void return_value(R result) { value = std::move(result); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    AsyncTask(AsyncTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    AsyncTask& operator=(AsyncTask&& other) noexcept {
+        if (this != &other) {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~AsyncTask() {
+        if (handle)
+            handle.destroy();
+    }
+
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            R await_resume() {
+                if (handle.promise().error)
+                    std::rethrow_exception(handle.promise().error);
+                return std::move(*handle.promise().value);
+            }
+        };
+        return Awaiter{handle};
+    }
+
+private:
+    explicit AsyncTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Sums data on the pool while suspended; see sum_async
+template<class T, class Acc, class Pool>
+class PoolSumAwaiter {
+public:
+    PoolSumAwaiter(std::span<const T> data, Pool& pool, std::stop_token stop, SumKernel kernel)
+        : data(data), pool(pool), stop(std::move(stop)), sum(sum_kernel<T, Acc>(kernel)),
+          numTasks(std::min(pool.size(), std::max<size_t>(data.size(), 1))), remaining(numTasks) {}
+
+    // A sum cancelled before it starts does not dispatch anything
+    bool await_ready() noexcept {
+        if (stop.stop_requested())
+            cancelled.store(true, std::memory_order_relaxed);
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        continuation = handle;
+        // The last chunk may resume, and so destroy, this awaiter before enqueue returns, so
+        // the loop must not read members
+        Pool& taskPool = pool;
+        size_t tasks = numTasks;
+        for (size_t i = 0; i < tasks; ++i)
+            taskPool.enqueue([this, i]() { run_chunk(i); });
+    }
+
+    Acc await_resume() const {
+        if (cancelled.load(std::memory_order_relaxed))
+            throw SumCancelled();
+        return total;
+    }
+
+private:
+    void run_chunk(size_t i) {
+        size_t chunk = data.size() / numTasks;
+        size_t start = i * chunk;
+        size_t end = (i == numTasks - 1) ? data.size() : start + chunk;
+        Acc localSum = 0;
+        for (; start < end; start += asyncCancelBlock) {
+            if (stop.stop_requested()) {
+                cancelled.store(true, std::memory_order_relaxed);
+                break;
+            }
+            localSum += sum(data.data() + start, std::min(asyncCancelBlock, end - start));
+        }
+        atomic_add(total, localSum, std::memory_order_relaxed);
+
+        // The final decrement orders every chunk's writes before the resumed coroutine
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuation.resume();
+    }
+
+    std::span<const T> data;
+    Pool& pool;
+    std::stop_token stop;
+    SumKernelFn<T, Acc> sum;
+    size_t numTasks;
+    std::atomic<size_t> remaining;
+    std::atomic<Acc> total{0};
+    std::atomic<bool> cancelled{false};
+    std::coroutine_handle<> continuation;
+};
+
+template<class T, class Acc = accumulator_t<T>, class Pool>
+AsyncTask<Acc> sum_async(std::span<const T> data, Pool& pool, std::stop_token stop = {},
+                         SumKernel kernel = SumKernel::Simd) {
+    co_return co_await PoolSumAwaiter<T, Acc, Pool>(data, pool, std::move(stop), kernel);
+}
+
+// Eagerly started coroutine that frees itself when it finishes
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template<class R>
+DetachedTask drive_task(AsyncTask<R>& task, std::optional<R>& result, std::exception_ptr& error,
+                        CompletionLatch& latch) {
+    try {
+        result = co_await task;
+    } catch (...) {
+        error = std::current_exception();
+    }
+    latch.count_down();
+}
+
+// Runs all tasks concurrently and blocks until every one has finished, for callers that are
+// not coroutines themselves. Rethrows the first error in task order.
+template<class R>
+std::vector<R> sync_wait_all(std::vector<AsyncTask<R>>& tasks) {
+    std::vector<std::optional<R>> results(tasks.size());
+    std::vector<std::exception_ptr> errors(tasks.size());
+    CompletionLatch latch(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i)
+        drive_task(tasks[i], results[i], errors[i], latch);
+    latch.wait();
+
+    std::vector<R> values;
+    values.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+        values.push_back(std::move(*results[i]));
+    }
+    return values;
+}
+
+template<class R>
+R sync_wait(AsyncTask<R> task) {
+    std::vector<AsyncTask<R>> tasks;
+    tasks.push_back(std::move(task));
+    return sync_wait_all(tasks)[0];
+}
+
+// GPU offload, see gpu_sum.h. Builds without the CUDA backend get this CPU fallback: it reports
+// no device, so offload_sum stays on the pool and the GPU columns read N/A.
+#if !defined(PARALLEL_SUM_CUDA)
+std::string gpu_device_name() { return ""; }
+void gpu_pin_host(const void*, size_t) {}
+void gpu_unpin_host(const void*) {}
+
+[[noreturn]] void gpu_unavailable() {
+    throw std::runtime_error("built without the GPU backend, configure with -DPARALLEL_SUM_CUDA=ON");
+}
+
+long long gpu_sum(std::span<const int16_t>, GpuInput, GpuSumTiming&) { gpu_unavailable(); }
+long long gpu_sum(std::span<const int32_t>, GpuInput, GpuSumTiming&) { gpu_unavailable(); }
+unsigned long long gpu_sum(std::span<const uint32_t>, GpuInput, GpuSumTiming&) { gpu_unavailable(); }
+long long gpu_sum(std::span<const int64_t>, GpuInput, GpuSumTiming&) { gpu_unavailable(); }
+double gpu_sum(std::span<const float>, GpuInput, GpuSumTiming&) { gpu_unavailable(); }
+double gpu_sum(std::span<const double>, GpuInput, GpuSumTiming&) { gpu_unavailable(); }
+#endif
+
+bool gpu_available() {
+    static const bool available = !gpu_device_name().empty();
+    return available;
+}
+
+// Sums on the GPU when there is one, otherwise on the pool
+template<class T, class Acc = accumulator_t<T>>
+Acc offload_sum(std::span<const T> data, ThreadPool& pool, GpuInput input = GpuInput::DeviceResident) {
+    if (gpu_available()) {
+        GpuSumTiming timing;
+        return gpu_sum(data, input, timing);
+    }
+    std::atomic<Acc> total(0);
+    threadpool_sum(data, total, pool);
+    return total.load();
+}
+
+// Autotuner: for every data-size bucket, the fastest of the single-threaded, ThreadPool and
+// fork-join sums, with the ThreadPool task count and the fork-join grain that won. The profile is
+// calibrated once per element type, on first use, at the upper bound of every bucket; inputs larger
+// than the last bucket use its choice. It can be saved and loaded, and a saved profile is ignored
+// on a machine with a different thread count or SIMD kernel.
+enum class TunedMethod { SingleThreaded, ThreadPool, ForkJoin };
+
+const char* to_string(TunedMethod method) {
+    switch (method) {
+    case TunedMethod::SingleThreaded: return "single";
+    case TunedMethod::ThreadPool: return "threadpool";
+    case TunedMethod::ForkJoin: return "fork-join";
+    }
+    return "unknown";
+}
+
+struct TunedChoice {
+    size_t maxSize = 0;         // bucket: inputs of up to maxSize elements
+    TunedMethod method = TunedMethod::SingleThreaded;
+    unsigned int threads = 1;   // ThreadPool tasks
+    size_t grain = 0;           // fork-join grain
+    double ms = -1;             // time at maxSize during calibration; negative when loaded from a profile
+};
+
+constexpr size_t tuneBuckets[] = {4096, 65536, size_t(1) << 20, size_t(16) << 20};
+constexpr size_t tuneGrains[] = {16384, 65536, 262144};
+constexpr int tuneRepetitions = 3;
+constexpr size_t tuneTimedElements = size_t(1) << 22;
+
+// Time of one call of func over size elements, averaged over enough calls to sum about
+// tuneTimedElements elements, so that small inputs rise above the timer resolution
+template<class Func>
+double time_per_call(size_t size, Func&& func) {
+    size_t calls = std::max<size_t>(tuneTimedElements / std::max<size_t>(size, 1), 1);
+    return measure_time([&]() {
+        for (size_t c = 0; c < calls; ++c)
+            func();
+    }) / calls;
+}
+
+class AutoTuner {
+public:
+    AutoTuner(ThreadPool& pool, WorkStealingPool& stealingPool) : pool(pool), stealingPool(stealingPool) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 2;
+    }
+
+    template<class T>
+    const std::vector<TunedChoice>& profile() {
+        auto& choices = profiles[element_type_name<T>()];
+        if (choices.empty())
+            choices = calibrate<T>();
+        return choices;
+    }
+
+    template<class T>
+    const TunedChoice& choose(size_t size) {
+        const auto& choices = profile<T>();
+        for (const auto& choice : choices) {
+            if (size <= choice.maxSize)
+                return choice;
+        }
+        return choices.back();
+    }
+
+    template<class T, class Acc = accumulator_t<T>>
+    Acc run(const TunedChoice& choice, std::span<const T> data) {
+        switch (choice.method) {
+        case TunedMethod::ThreadPool: {
+            std::atomic<Acc> total(0);
+            threadpool_sum(data, total, pool, SumKernel::Simd, choice.threads);
+            return total.load();
+        }
+        case TunedMethod::ForkJoin:
+            return fork_join_sum<T, Acc>(data, 0, data.size(), stealingPool, choice.grain);
+        case TunedMethod::SingleThreaded:
+            break;
+        }
+        Acc total;
+        single_thread_sum(data, total);
+        return total;
+    }
+
+    // Loads a saved profile; false if the file is missing, malformed or from another machine
+    bool load(const std::string& path) {
+        std::ifstream file(path);
+        std::string line, key, kernel;
+        unsigned int savedThreads = 0;
+        if (!std::getline(file, line) || !std::getline(file, line))
+            return false;
+        std::istringstream header(line);
+        if (!(header >> key >> savedThreads >> kernel) || key != "threads"
+            || savedThreads != threads || kernel != simd_kernel().name)
+            return false;
+
+        std::map<std::string, std::vector<TunedChoice>> loaded;
+        while (std::getline(file, line)) {
+            std::istringstream entry(line);
+            std::string type, method;
+            TunedChoice choice;
+            if (!(entry >> type >> choice.maxSize >> method >> choice.threads >> choice.grain))
+                return false;
+            if (method == "single")
+                choice.method = TunedMethod::SingleThreaded;
+            else if (method == "threadpool")
+                choice.method = TunedMethod::ThreadPool;
+            else if (method == "fork-join")
+                choice.method = TunedMethod::ForkJoin;
+            else
+                return false;
+            loaded[type].push_back(choice);
+        }
+        profiles = std::move(loaded);
+        return true;
+    }
+
+    void save(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file)
+            throw std::runtime_error("cannot write " + zen::quote(path));
+        file << "# summation autotuner profile: type max-elements method threads grain\n";
+        file << "threads " << threads << " " << simd_kernel().name << "\n";
+        for (const auto& [type, choices] : profiles) {
+            for (const auto& choice : choices) {
+                file << type << " " << choice.maxSize << " " << to_string(choice.method) << " "
+                     << choice.threads << " " << choice.grain << "\n";
+            }
+        }
+    }
+
+private:
+    template<class T>
+    std::vector<TunedChoice> calibrate() {
+        pool.resize(threads);
+        stealingPool.resize(threads);
+        std::vector<T> storage(tuneBuckets[std::size(tuneBuckets) - 1]);
+        fill_sequence<T>(storage);
+
+        std::vector<TunedChoice> candidates = {TunedChoice{}};
+        for (unsigned int t = 2; t < threads; t *= 2)
+            candidates.push_back({0, TunedMethod::ThreadPool, t, 0});
+        if (threads > 1)
+            candidates.push_back({0, TunedMethod::ThreadPool, threads, 0});
+        for (size_t grain : tuneGrains)
+            candidates.push_back({0, TunedMethod::ForkJoin, threads, grain});
+
+        std::vector<TunedChoice> choices;
+        for (size_t size : tuneBuckets) {
+            std::span<const T> data(storage.data(), size);
+            TunedChoice best;
+            best.ms = std::numeric_limits<double>::infinity();
+            for (auto candidate : candidates) {
+                if (candidate.method == TunedMethod::ForkJoin && (threads == 1 || candidate.grain >= size))
+                    continue;
+                // Best of a few runs after a warmup run; the sink keeps inlined sums from being dropped
+                volatile accumulator_t<T> sink = run<T>(candidate, data);
+                candidate.ms = std::numeric_limits<double>::infinity();
+                for (int r = 0; r < tuneRepetitions; ++r)
+                    candidate.ms = std::min(candidate.ms, time_per_call(size, [&]() { sink = run<T>(candidate, data); }));
+                if (candidate.ms < best.ms)
+                    best = candidate;
+            }
+            best.maxSize = size;
+            choices.push_back(best);
+        }
+        return choices;
+    }
+
+    ThreadPool& pool;
+    WorkStealingPool& stealingPool;
+    unsigned int threads;
+    std::map<std::string, std::vector<TunedChoice>> profiles;
+};
+
+// Sums with the method, thread count and grain tuned for the size of data
+template<class T, class Acc = accumulator_t<T>>
+Acc auto_sum(std::span<const T> data, AutoTuner& tuner) {
+    return tuner.run<T, Acc>(tuner.choose<T>(data.size()), data);
+}
+
+// Incremental sum over data that grows by appends and changes by point updates. Per-block partial
+// sums of blockSize elements and a running total are kept up to date, so appends cost O(new data),
+// updates O(1) and total() does not rescan. With RangeIndex::Fenwick the block sums also sit in a
+// Fenwick tree, making range_sum over [start, end) O(blockSize + log(blocks)) instead of
+// O(blockSize + blocks), at the price of O(log(blocks)) updates. Floating-point totals pick up
+// rounding error from every update; rebuild() recomputes them exactly.
+enum class RangeIndex { Blocks, Fenwick };
+
+constexpr size_t runningBlockSize = 4096;
+
+template<class T, class Acc = accumulator_t<T>>
+class RunningSum {
+public:
+    explicit RunningSum(RangeIndex index = RangeIndex::Blocks, size_t blockSize = runningBlockSize,
+                        SumKernel kernel = SumKernel::Simd)
+        : rangeIndex(index), blockSize(std::max<size_t>(blockSize, 1)), sum(sum_kernel<T, Acc>(kernel)) {}
+
+    void append(std::span<const T> values) {
+        size_t offset = 0;
+        while (offset < values.size()) {
+            size_t used = elements.size() % blockSize;
+            if (used == 0)
+                push_block();
+            size_t count = std::min(blockSize - used, values.size() - offset);
+            elements.insert(elements.end(), values.begin() + offset, values.begin() + offset + count);
+            add_to_block(blockSums.size() - 1, sum(values.data() + offset, count));
+            offset += count;
+        }
+    }
+
+    void update(size_t position, T value) {
+        Acc delta = Acc(value) - Acc(elements[position]);
+        elements[position] = value;
+        add_to_block(position / blockSize, delta);
+    }
+
+    Acc total() const { return runningTotal; }
+
+    Acc range_sum(size_t start, size_t end) const {
+        end = std::min(end, elements.size());
+        if (start >= end)
+            return Acc(0);
+        size_t firstBlock = start / blockSize;
+        size_t lastBlock = end / blockSize;
+        if (firstBlock == lastBlock)
+            return sum(elements.data() + start, end - start);
+
+        // Partial blocks at both ends are scanned, the whole blocks between them come from the index
+        size_t headEnd = (firstBlock + 1) * blockSize;
+        Acc result = sum(elements.data() + start, headEnd - start);
+        result += blocks_sum(firstBlock + 1, lastBlock);
+        result += sum(elements.data() + lastBlock * blockSize, end - lastBlock * blockSize);
+        return result;
+    }
+
+    // Recomputes every block sum, the index and the total from the stored values
+    void rebuild() {
+        std::vector<T> stored;
+        stored.swap(elements);
+        blockSums.clear();
+        fenwick.assign(1, Acc(0));
+        runningTotal = Acc(0);
+        append(stored);
+    }
+
+    size_t size() const { return elements.size(); }
+    T operator[](size_t position) const { return elements[position]; }
+
+private:
+    void push_block() {
+        blockSums.push_back(Acc(0));
+        if (rangeIndex == RangeIndex::Fenwick) {
+            // Node i covers blocks (i - lowbit(i), i]; all of them but the new, empty one exist
+            size_t i = blockSums.size();
+            fenwick.push_back(prefix(i - 1) - prefix(i - (i & (~i + 1))));
+        }
+    }
+
+    void add_to_block(size_t block, Acc delta) {
+        blockSums[block] += delta;
+        runningTotal += delta;
+        if (rangeIndex == RangeIndex::Fenwick) {
+            for (size_t i = block + 1; i < fenwick.size(); i += i & (~i + 1))
+                fenwick[i] += delta;
+        }
+    }
+
+    // Sum of the first count blocks
+    Acc prefix(size_t count) const {
+        Acc result = Acc(0);
+        for (size_t i = count; i > 0; i -= i & (~i + 1))
+            result += fenwick[i];
+        return result;
+    }
+
+    Acc blocks_sum(size_t first, size_t last) const {
+        if (rangeIndex == RangeIndex::Fenwick)
+            return prefix(last) - prefix(first);
+        Acc result = Acc(0);
+        for (size_t b = first; b < last; ++b)
+            result += blockSums[b];
+        return result;
+    }
+
+    RangeIndex rangeIndex;
+    size_t blockSize;
+    SumKernelFn<T, Acc> sum;
+    std::vector<T> elements;
+    std::vector<Acc> blockSums;
+    std::vector<Acc> fenwick = std::vector<Acc>(1, Acc(0));  // 1-based
+    Acc runningTotal = Acc(0);
+};
+
+// Encoded int32 columns, summed without decoding them into memory. Values sit in blocks of
+// encodedBlockSize, each bit-packed in the lane-interleaved layout of SIMD-BP128 widened to
+// encodedLanes lanes: value j of a block goes to lane j % 8, every lane packs its 32 values into
+// `bits` 32-bit words, and word w of all lanes is stored together. Unpacking is then the same
+// shift and mask on every lane at offsets fixed by the bit width, so the per-width kernels below
+// unpack straight into vector registers and add there. They run as their WidestVariant: the eight
+// 32-bit lanes fill an AVX2 register, and the eight 64-bit lane sums an AVX-512 one.
+//   BitPacked:        the values themselves, at one width for the whole column; none negative
+//   FrameOfReference: value minus the block minimum, at the block's own width
+//   Delta:            difference to the previous value minus the smallest difference in the
+//                     block. The block sum is n * first + minDelta * n(n-1)/2 plus every packed
+//                     difference weighted by the n - j values it is part of, so no prefix sum is
+//                     materialized either. Blocks whose differences span more than 32 bits are
+//                     stored frame-of-reference.
+constexpr size_t encodedBlockSize = 256;
+constexpr size_t encodedLanes = 8;
+constexpr unsigned int maxPackedBits = 32;
+
+enum class Encoding { BitPacked, FrameOfReference, Delta };
+
+const char* to_string(Encoding encoding) {
+    switch (encoding) {
+    case Encoding::BitPacked:        return "bit-packed";
+    case Encoding::FrameOfReference: return "frame-of-ref";
+    case Encoding::Delta:            return "delta";
+    }
+    return "unknown";
+}
+
+struct EncodedBlock {
+    Encoding encoding;
+    unsigned int bits;
+    size_t count;         // encodedBlockSize except in the last block
+    size_t offset;        // first word of the block in EncodedColumn::words
+    long long base;       // 0, the block minimum, or the first value for Delta
+    long long minDelta;   // Delta only
+};
+
+struct EncodedColumn {
+    Encoding encoding = Encoding::BitPacked;
+    size_t count = 0;
+    std::vector<EncodedBlock> blocks;
+    std::vector<uint32_t> words;
+
+    size_t bytes() const { return blocks.size() * sizeof(EncodedBlock) + words.size() * sizeof(uint32_t); }
+};
+
+// Appends one block of packed values; the unused tail of a short block packs as zeros
+void pack_block(const uint64_t* values, size_t count, unsigned int bits, std::vector<uint32_t>& words) {
+    size_t offset = words.size();
+    words.resize(offset + bits * encodedLanes, 0);
+    for (size_t j = 0; bits > 0 && j < count; ++j) {
+        size_t lane = j % encodedLanes, bit = j / encodedLanes * bits;
+        size_t word = bit / 32, shift = bit % 32;
+        words[offset + word * encodedLanes + lane] |= static_cast<uint32_t>(values[j] << shift);
+        if (shift + bits > 32)
+            words[offset + (word + 1) * encodedLanes + lane] |= static_cast<uint32_t>(values[j] >> (32 - shift));
+    }
+}
+
+EncodedColumn encode_column(std::span<const int32_t> data, Encoding encoding) {
+    EncodedColumn column;
+    column.encoding = encoding;
+    column.count = data.size();
+
+    unsigned int columnBits = 0;
+    if (encoding == Encoding::BitPacked) {
+        if (std::any_of(data.begin(), data.end(), [](int32_t x) { return x < 0; }))
+            throw std::runtime_error("bit-packed encoding needs non-negative values");
+        int32_t maxValue = data.empty() ? 0 : *std::max_element(data.begin(), data.end());
+        columnBits = std::bit_width(static_cast<uint32_t>(maxValue));
+    }
+
+    uint64_t packed[encodedBlockSize];
+    for (size_t start = 0; start < data.size(); start += encodedBlockSize) {
+        std::span<const int32_t> values = data.subspan(start, std::min(encodedBlockSize, data.size() - start));
+        EncodedBlock block{encoding, columnBits, values.size(), column.words.size(), 0, 0};
+
+        if (encoding == Encoding::Delta) {
+            long long minDelta = 0, maxDelta = 0;
+            for (size_t j = 1; j < values.size(); ++j) {
+                long long delta = (long long)values[j] - values[j - 1];
+                minDelta = j == 1 ? delta : std::min(minDelta, delta);
+                maxDelta = j == 1 ? delta : std::max(maxDelta, delta);
+            }
+            unsigned int bits = std::bit_width(static_cast<uint64_t>(maxDelta - minDelta));
+            if (bits <= maxPackedBits) {
+                packed[0] = 0;
+                for (size_t j = 1; j < values.size(); ++j)
+                    packed[j] = static_cast<uint64_t>((long long)values[j] - values[j - 1] - minDelta);
+                block.bits = bits;
+                block.base = values[0];
+                block.minDelta = minDelta;
+            } else {
+                block.encoding = Encoding::FrameOfReference;
+            }
+        }
+        if (block.encoding == Encoding::FrameOfReference) {
+            auto [minValue, maxValue] = std::minmax_element(values.begin(), values.end());
+            for (size_t j = 0; j < values.size(); ++j)
+                packed[j] = static_cast<uint64_t>((long long)values[j] - *minValue);
+            block.bits = std::bit_width(static_cast<uint64_t>((long long)*maxValue - *minValue));
+            block.base = *minValue;
+        } else if (block.encoding == Encoding::BitPacked) {
+            for (size_t j = 0; j < values.size(); ++j)
+                packed[j] = static_cast<uint64_t>(values[j]);
+        }
+
+        pack_block(packed, values.size(), block.bits, column.words);
+        column.blocks.push_back(block);
+    }
+    return column;
+}
+
+// Value at position P of a lane
+template<unsigned int Bits, size_t P>
+SIMD_INLINE uint32_t unpack_lane(const uint32_t* words, size_t lane) {
+    constexpr size_t bit = P * Bits, word = bit / 32, shift = bit % 32;
+    constexpr uint32_t mask = Bits == 32 ? ~0u : (1u << Bits) - 1;
+    uint32_t value = words[word * encodedLanes + lane] >> shift;
+    if constexpr (shift + Bits > 32)
+        value |= words[(word + 1) * encodedLanes + lane] << (32 - shift);
+    return value & mask;
+}
+
+// Unpacks position P of every lane and adds it, times Weighted ? n - j : 1, to the lane sums
+template<unsigned int Bits, size_t P, bool Weighted>
+SIMD_INLINE void add_packed_position(const uint32_t* words, uint64_t (&sums)[encodedLanes], uint64_t n) {
+    for (size_t lane = 0; lane < encodedLanes; ++lane) {
+        uint32_t value = unpack_lane<Bits, P>(words, lane);
+        // Unsigned wrap-around: padding positions past n weigh negative but hold zero
+        if constexpr (Weighted)
+            sums[lane] += uint64_t(value) * (n - (P * encodedLanes + lane));
+        else
+            sums[lane] += value;
+    }
+}
+
+// Every position of a block; a function rather than a lambda, which could not be SIMD_INLINE
+template<unsigned int Bits, bool Weighted, size_t... P>
+SIMD_INLINE void add_packed_positions(const uint32_t* words, uint64_t (&sums)[encodedLanes], uint64_t n,
+                                      std::index_sequence<P...>) {
+    (add_packed_position<Bits, P, Weighted>(words, sums, n), ...);
+}
+
+template<unsigned int Bits, bool Weighted>
+SIMD_INLINE uint64_t packed_block_sum(const uint32_t* words, uint64_t n) {
+    uint64_t sums[encodedLanes] = {};
+    if constexpr (Bits > 0)
+        add_packed_positions<Bits, Weighted>(words, sums, n,
+                                             std::make_index_sequence<encodedBlockSize / encodedLanes>());
+    uint64_t sum = 0;
+    for (uint64_t laneSum : sums)
+        sum += laneSum;
+    return sum;
+}
+
+using PackedSumFn = uint64_t (*)(const uint32_t*, uint64_t);
+
+// The kernel of every bit width, as the variant for the detected vector width
+template<bool Weighted, unsigned int... Bits>
+std::array<PackedSumFn, sizeof...(Bits)> packed_sum_table(std::integer_sequence<unsigned int, Bits...>) {
+    return {WidestVariant<&packed_block_sum<Bits, Weighted>>::pick()...};
+}
+
+long long encoded_block_sum(const EncodedColumn& column, const EncodedBlock& block) {
+    static const auto packedSums =
+        packed_sum_table<false>(std::make_integer_sequence<unsigned int, maxPackedBits + 1>());
+    static const auto packedWeightedSums =
+        packed_sum_table<true>(std::make_integer_sequence<unsigned int, maxPackedBits + 1>());
+    const uint32_t* words = column.words.data() + block.offset;
+    long long n = static_cast<long long>(block.count);
+    if (block.encoding == Encoding::Delta)
+        return n * block.base + block.minDelta * (n * (n - 1) / 2)
+             + static_cast<long long>(packedWeightedSums[block.bits](words, block.count));
+    return n * block.base + static_cast<long long>(packedSums[block.bits](words, block.count));
+}
+
+long long encoded_sum(const EncodedColumn& column) {
+    long long sum = 0;
+    for (const EncodedBlock& block : column.blocks)
+        sum += encoded_block_sum(column, block);
+    return sum;
+}
+
+// Blocks are split over the pool in contiguous runs, one per worker
+template<class Pool>
+long long encoded_sum(const EncodedColumn& column, Pool& pool) {
+    size_t numTasks = std::min(pool.size(), std::max<size_t>(column.blocks.size(), 1));
+    std::vector<long long> partials(numTasks, 0);
+    CompletionLatch latch(numTasks);
+    for (size_t i = 0; i < numTasks; ++i) {
+        pool.enqueue([&column, &partials, &latch, i, numTasks]() {
+            size_t first = column.blocks.size() * i / numTasks, last = column.blocks.size() * (i + 1) / numTasks;
+            long long sum = 0;
+            for (size_t b = first; b < last; ++b)
+                sum += encoded_block_sum(column, column.blocks[b]);
+            partials[i] = sum;
+            latch.count_down();
+        });
+    }
+    latch.wait();
+    return std::accumulate(partials.begin(), partials.end(), 0LL);
+}
+
+// Unpacks a whole block to out, for decode_column
+template<unsigned int Bits, size_t P>
+SIMD_INLINE void unpack_position(const uint32_t* words, uint32_t* out) {
+    // Unpacked in full before the stores, which could otherwise alias the words
+    uint32_t values[encodedLanes];
+    for (size_t lane = 0; lane < encodedLanes; ++lane)
+        values[lane] = unpack_lane<Bits, P>(words, lane);
+    for (size_t lane = 0; lane < encodedLanes; ++lane)
+        out[P * encodedLanes + lane] = values[lane];
+}
+
+template<unsigned int Bits, size_t... P>
+SIMD_INLINE void unpack_positions(const uint32_t* words, uint32_t* out, std::index_sequence<P...>) {
+    (unpack_position<Bits, P>(words, out), ...);
+}
+
+template<unsigned int Bits>
+SIMD_INLINE void unpack_block(const uint32_t* words, uint32_t* out) {
+    if constexpr (Bits == 0) {
+        for (size_t j = 0; j < encodedBlockSize; ++j)
+            out[j] = 0;
+    } else {
+        unpack_positions<Bits>(words, out, std::make_index_sequence<encodedBlockSize / encodedLanes>());
+    }
+}
+
+using UnpackBlockFn = void (*)(const uint32_t*, uint32_t*);
+
+template<unsigned int... Bits>
+std::array<UnpackBlockFn, sizeof...(Bits)> unpack_block_table(std::integer_sequence<unsigned int, Bits...>) {
+    return {WidestVariant<&unpack_block<Bits>>::pick()...};
+}
+
+// Writes the decoded column to out, which holds column.count elements
+void decode_column(const EncodedColumn& column, std::span<int32_t> out) {
+    static const auto unpackBlocks =
+        unpack_block_table(std::make_integer_sequence<unsigned int, maxPackedBits + 1>());
+    uint32_t packed[encodedBlockSize];
+    int32_t* values = out.data();
+    for (const EncodedBlock& block : column.blocks) {
+        unpackBlocks[block.bits](column.words.data() + block.offset, packed);
+        if (block.encoding == Encoding::Delta) {
+            long long value = block.base;
+            for (size_t j = 0; j < block.count; ++j) {
+                value += j == 0 ? 0 : packed[j] + block.minDelta;
+                values[j] = static_cast<int32_t>(value);
+            }
+        } else {
+            for (size_t j = 0; j < block.count; ++j)
+                values[j] = static_cast<int32_t>(block.base + packed[j]);
+        }
+        values += block.count;
+    }
+}
+
+// Machine-readable results: with --format, every timed run of the basic comparison and every
+// point of the thread and workload scaling tables is kept as a record, and written as JSON or CSV
+// together with host metadata. A file written this way can serve as the baseline for --compare.
+#ifndef BUILD_FLAGS
+#define BUILD_FLAGS ""
+#endif
+#ifndef BUILD_TYPE
+#define BUILD_TYPE ""
+#endif
+
+struct BenchmarkRecord {
+    std::string type;
+    std::string method;
+    std::string memoryOrder;    // "N/A" where it does not apply
+    std::string kernel;
+    unsigned int threads = 0;
+    size_t size = 0;
+    int rep = 0;
+    double ms = 0;
+};
+
+inline bool recordResults = false;
+inline std::vector<BenchmarkRecord> benchmarkRecords;
+
+void record_result(BenchmarkRecord record) {
+    if (recordResults)
+        benchmarkRecords.push_back(std::move(record));
+}
+
+struct HostInfo {
+    std::string cpu;
+    unsigned int cores;
+    std::string compiler;
+    std::string flags;
+    std::string buildType;
+    std::string simdKernel;
+};
+
+std::string cpu_model() {
+#if defined(__linux__)
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0 || line.rfind("Model", 0) == 0) {
+            auto colon = line.find(':');
+            if (colon != std::string::npos && colon + 2 <= line.size())
+                return line.substr(colon + 2);
+        }
+    }
+#elif defined(SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    char brand[49] = {};
+    __cpuid(info, 0x80000000);
+    if (static_cast<unsigned int>(info[0]) >= 0x80000004) {
+        for (int leaf = 0; leaf < 3; ++leaf) {
+            __cpuid(info, 0x80000002 + leaf);
+            std::memcpy(brand + 16 * leaf, info, 16);
+        }
+        return brand;
+    }
+#endif
+    return "unknown";
+}
+
+HostInfo host_info() {
+    HostInfo host;
+    host.cpu = cpu_model();
+    host.cores = std::thread::hardware_concurrency();
+#if defined(__clang__)
+    host.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    host.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    host.compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    host.compiler = "unknown";
+#endif
+    host.flags = BUILD_FLAGS;
+    host.buildType = BUILD_TYPE;
+    host.simdKernel = simd_kernel().name;
+    return host;
+}
+
+std::string csv_field(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos)
+        return text;
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// One record per line, so that load_records can read it back without a JSON library
+void write_records_json(std::ostream& out, const HostInfo& host, const std::vector<BenchmarkRecord>& records) {
+    out << "{\n  \"host\": {\"cpu\": " << json_string(host.cpu)
+        << ", \"cores\": " << host.cores
+        << ", \"compiler\": " << json_string(host.compiler)
+        << ", \"flags\": " << json_string(host.flags)
+        << ", \"build_type\": " << json_string(host.buildType)
+        << ", \"simd_kernel\": " << json_string(host.simdKernel) << "},\n";
+    out << "  \"records\": [\n";
+    out << std::setprecision(6) << std::defaultfloat;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto& r = records[i];
+        out << "    {\"type\": " << json_string(r.type)
+            << ", \"method\": " << json_string(r.method)
+            << ", \"memory_order\": " << json_string(r.memoryOrder)
+            << ", \"kernel\": " << json_string(r.kernel)
+            << ", \"threads\": " << r.threads
+            << ", \"size\": " << r.size
+            << ", \"rep\": " << r.rep
+            << ", \"ms\": " << r.ms << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void write_records_csv(std::ostream& out, const HostInfo& host, const std::vector<BenchmarkRecord>& records) {
+    out << "type,method,memory_order,kernel,threads,size,rep,ms,cpu,cores,compiler,flags,build_type,simd_kernel\n";
+    std::string hostFields = csv_field(host.cpu) + "," + std::to_string(host.cores) + "," + csv_field(host.compiler)
+                           + "," + csv_field(host.flags) + "," + csv_field(host.buildType) + "," + csv_field(host.simdKernel);
+    out << std::setprecision(6) << std::defaultfloat;
+    for (const auto& r : records) {
+        out << csv_field(r.type) << "," << csv_field(r.method) << "," << csv_field(r.memoryOrder) << ","
+            << csv_field(r.kernel) << "," << r.threads << "," << r.size << "," << r.rep << "," << r.ms << ","
+            << hostFields << "\n";
+    }
+}
+
+std::vector<std::string> split_csv_line(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+                fields.back() += line[++i];
+            else if (c == '"')
+                quoted = false;
+            else
+                fields.back() += c;
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+// Value of "key": in a line written by write_records_json, unquoted
+std::string json_field(const std::string& line, const std::string& key) {
+    std::string pattern = "\"" + key + "\": ";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos)
+        return "";
+    pos += pattern.size();
+    std::string value;
+    if (pos < line.size() && line[pos] == '"') {
+        for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+            if (line[pos] == '\\' && pos + 1 < line.size())
+                ++pos;
+            value += line[pos];
+        }
+    } else {
+        while (pos < line.size() && line[pos] != ',' && line[pos] != '}')
+            value += line[pos++];
+    }
+    return value;
+}
+
+// The whole of text as a T; nullopt if it is not a number or does not fit. Base 0 takes the base
+// of an integer from its prefix, as strtoul does: 0x for hexadecimal, 0 for octal.
+template<class T>
+std::optional<T> parse_number(const std::string& text, int base = 10) {
+    const char* first = text.data();
+    const char* last = first + text.size();
+    T value{};
+    std::from_chars_result result;
+    if constexpr (std::is_integral_v<T>) {
+        if (base == 0) {
+            base = 10;
+            if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+                first += 2;
+                base = 16;
+            } else if (last - first > 1 && first[0] == '0') {
+                first += 1;
+                base = 8;
+            }
+        }
+        result = std::from_chars(first, last, value, base);
+    } else {
+        result = std::from_chars(first, last, value);
+    }
+    if (result.ec != std::errc() || result.ptr != last)
+        return std::nullopt;
+    return value;
+}
+
+// Reads records from a file written by --format json or --format csv
+std::vector<BenchmarkRecord> load_records(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("cannot open " + zen::quote(path));
+    std::vector<BenchmarkRecord> records;
+    std::string line;
+    if (!std::getline(file, line))
+        return records;
+    bool json = line.rfind("{", 0) == 0;
+    auto number = [&]<class N>(const std::string& text, N& value) {
+        auto parsed = parse_number<N>(text);
+        if (!parsed)
+            throw std::runtime_error(zen::quote(path) + " is not a --format json or csv results file");
+        value = *parsed;
+    };
+    while (std::getline(file, line)) {
+        BenchmarkRecord r;
+        if (json) {
+            if (line.find("\"method\": ") == std::string::npos)
+                continue;
+            r.type = json_field(line, "type");
+            r.method = json_field(line, "method");
+            r.memoryOrder = json_field(line, "memory_order");
+            r.kernel = json_field(line, "kernel");
+            number(json_field(line, "threads"), r.threads);
+            number(json_field(line, "size"), r.size);
+            number(json_field(line, "rep"), r.rep);
+            number(json_field(line, "ms"), r.ms);
+        } else {
+            auto fields = split_csv_line(line);
+            if (fields.size() < 8)
+                continue;
+            r.type = fields[0];
+            r.method = fields[1];
+            r.memoryOrder = fields[2];
+            r.kernel = fields[3];
+            number(fields[4], r.threads);
+            number(fields[5], r.size);
+            number(fields[6], r.rep);
+            number(fields[7], r.ms);
+        }
+        records.push_back(std::move(r));
+    }
+    return records;
+}
+
+// Median time of every (type, method, memory order, kernel, threads, size) over its reps
+std::map<std::tuple<std::string, std::string, std::string, std::string, unsigned int, size_t>, double>
+median_times(const std::vector<BenchmarkRecord>& records) {
+    std::map<std::tuple<std::string, std::string, std::string, std::string, unsigned int, size_t>,
+             std::vector<double>> samples;
+    for (const auto& r : records)
+        samples[{r.type, r.method, r.memoryOrder, r.kernel, r.threads, r.size}].push_back(r.ms);
+    std::map<std::tuple<std::string, std::string, std::string, std::string, unsigned int, size_t>, double> medians;
+    for (auto& [key, times] : samples) {
+        std::sort(times.begin(), times.end());
+        medians[key] = percentile(times, 50);
+    }
+    return medians;
+}
+
+// Compares the medians of this run against a baseline; returns the number of regressions, i.e.
+// configurations more than thresholdPercent slower. Configurations missing on either side are skipped.
+size_t compare_records(const std::vector<BenchmarkRecord>& baseline, const std::vector<BenchmarkRecord>& current,
+                       double thresholdPercent) {
+    auto before = median_times(baseline);
+    auto after = median_times(current);
+
+    std::cout << "\n=== Comparison Against Baseline (threshold " << thresholdPercent << "%) ===\n";
+    std::cout << std::left << std::setw(8) << "Type"
+              << std::setw(26) << "Method"
+              << std::setw(12) << "Order"
+              << std::setw(8) << "Kernel"
+              << std::setw(9) << "Threads"
+              << std::setw(12) << "Size"
+              << std::setw(15) << "Baseline (ms)"
+              << std::setw(14) << "Current (ms)"
+              << std::setw(10) << "Change"
+              << std::setw(12) << "Status" << "\n";
+    std::cout << zen::repeat("-", 126) << "\n";
+
+    size_t regressions = 0;
+    for (const auto& [key, ms] : after) {
+        auto base = before.find(key);
+        if (base == before.end() || base->second <= 0)
+            continue;
+        double change = (ms / base->second - 1.0) * 100.0;
+        const char* status = "ok";
+        if (change > thresholdPercent) {
+            status = "REGRESSION";
+            ++regressions;
+        } else if (change < -thresholdPercent) {
+            status = "improved";
+        }
+        const auto& [type, method, order, kernel, threads, size] = key;
+        std::ostringstream changeText;
+        changeText << std::showpos << std::fixed << std::setprecision(1) << change << "%";
+        std::cout << std::setw(8) << type
+                  << std::setw(26) << method
+                  << std::setw(12) << order
+                  << std::setw(8) << kernel
+                  << std::setw(9) << threads
+                  << std::setw(12) << size
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(15) << base->second
+                  << std::setw(14) << ms
+                  << std::setw(10) << changeText.str()
+                  << std::setw(12) << status << "\n";
+    }
+    std::cout << regressions << " regression(s)\n";
+    return regressions;
+}
+
+// While active, std::cout goes to stderr, so that stdout carries nothing but the records
+class StdoutRedirect {
+public:
+    explicit StdoutRedirect(bool active) : stdoutBuffer(std::cout.rdbuf()) {
+        if (active)
+            std::cout.rdbuf(std::cerr.rdbuf());
+    }
+    ~StdoutRedirect() { std::cout.rdbuf(stdoutBuffer); }
+
+    StdoutRedirect(const StdoutRedirect&) = delete;
+    StdoutRedirect& operator=(const StdoutRedirect&) = delete;
+
+    std::streambuf* stdout_buffer() const { return stdoutBuffer; }
+
+private:
+    std::streambuf* stdoutBuffer;
+};
+
+template<class T>
+void benchmark_thread_scaling(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Thread Scaling Analysis ===\n";
+    std::cout << std::left << std::setw(10) << "Threads"
+              << std::setw(20) << "Atomic Sum (ms)"
+              << std::setw(20) << "Reduce Sum (ms)"
+              << std::setw(20) << "Reduce Padded (ms)"
+              << std::setw(18) << "Padding Gain"
+              << std::setw(22) << "ThreadPool Sum (ms)"
+              << std::setw(20) << "Prefix Scan (ms)"
+              << std::setw(22) << "Thread Overhead (ms)"
+              << std::setw(18) << "NUMA Local (ms)"
+              << std::setw(18) << "Interleaved (ms)" << "\n";
+    std::cout << zen::repeat("-", 188) << "\n";
+
+    std::vector<Acc> prefix(data.size());
+    std::vector<uint32_t> tracedRuns;
+    std::vector<unsigned int> threadCounts = {1, 2, 4, 8, 12, 16};
+    unsigned int maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads > 16) {
+        threadCounts.push_back(maxThreads);
+    }
+
+    for (unsigned int numThreads : threadCounts) {
+        if (numThreads > maxThreads && numThreads != maxThreads) continue;
+
+        // Atomic sum benchmark with thread timing
+        std::atomic<Acc> atomicTotal(0);
+        double atomicCreationTime = 0, atomicJoinTime = 0;
+        double atomicTime = measure_time([&]() {
+            atomic_sum(data, atomicTotal, std::memory_order_relaxed, numThreads, SumKernel::Simd, Schedule::Static,
+                       &atomicCreationTime, &atomicJoinTime, &worker_trace(),
+                       std::string("Atomic Sum (") + element_type_name<T>() + ")");
+        });
+        tracedRuns.push_back(static_cast<uint32_t>(worker_trace().trace_runs().size() - 1));
+
+        // Reduce sum benchmark with thread timing
+        std::vector<Acc> partialSums(numThreads, 0);
+        double reduceCreationTime = 0, reduceJoinTime = 0;
+        double reduceTime = measure_time([&]() {
+            reduce_sum(data, partialSums, numThreads, ReduceLayout::Naive, SumKernel::Simd, Schedule::Static,
+                       &reduceCreationTime, &reduceJoinTime, &worker_trace(),
+                       std::string("Reduce Sum (") + element_type_name<T>() + ")");
+        });
+        tracedRuns.push_back(static_cast<uint32_t>(worker_trace().trace_runs().size() - 1));
+
+        // Padded reduce sum benchmark
+        std::vector<Acc> paddedPartialSums(numThreads, 0);
+        double paddedTime = measure_time([&]() {
+            reduce_sum(data, paddedPartialSums, numThreads, ReduceLayout::Padded);
+        });
+
+        // ThreadPool sum benchmark; resizing happens outside the timed region
+        pool.resize(numThreads);
+        std::atomic<Acc> poolTotal(0);
+        double poolTime = measure_time([&]() {
+            threadpool_sum(data, poolTotal, pool);
+        });
+        double scanTime = measure_time([&]() {
+            scan_sum(data, std::span<Acc>(prefix), pool);
+        });
+
+        // Calculate average thread overhead (creation + join)
+        double avgThreadOverhead = (atomicCreationTime + atomicJoinTime + reduceCreationTime + reduceJoinTime) / 2.0;
+
+        // Atomic sum over copies first-touched chunk-locally and page-interleaved for this thread count
+        double placedTimes[2];
+        const Placement placements[] = {Placement::Local, Placement::Interleaved};
+        for (int p = 0; p < 2; ++p) {
+            PlacedBuffer<T> placed(data.size(), placements[p], numThreads);
+            std::atomic<Acc> placedTotal(0);
+            placedTimes[p] = measure_time([&]() {
+                atomic_sum(placed.view(), placedTotal, std::memory_order_relaxed, numThreads);
+            });
+        }
+
+        const std::tuple<const char*, const char*, double> points[] = {
+            {"Atomic Sum", "relaxed", atomicTime},
+            {"Reduce Sum", "N/A", reduceTime},
+            {"Reduce Sum (padded)", "N/A", paddedTime},
+            {"ThreadPool Sum", "N/A", poolTime},
+            {"Prefix Scan", "inclusive", scanTime},
+            {"Atomic Sum (NUMA local)", "relaxed", placedTimes[0]},
+            {"Atomic Sum (interleaved)", "relaxed", placedTimes[1]},
+        };
+        for (const auto& [method, order, ms] : points)
+            record_result({element_type_name<T>(), method, order, "simd", numThreads, data.size(), 0, ms});
+
+        std::cout << std::setw(10) << numThreads
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(20) << atomicTime
+                  << std::setw(20) << reduceTime
+                  << std::setw(20) << paddedTime
+                  << std::setw(18) << reduceTime / paddedTime
+                  << std::setw(22) << poolTime
+                  << std::setw(20) << scanTime
+                  << std::setw(22) << avgThreadOverhead
+                  << std::setw(18) << placedTimes[0]
+                  << std::setw(18) << placedTimes[1] << "\n";
+    }
+
+    print_worker_timeline(worker_trace(), tracedRuns);
+}
+
+// Setup cost of a dataSize-element input: a value-initialized std::vector filled serially, against
+// the page allocator with each huge page mode, filled serially or on the pool. The single-threaded
+// sum afterwards shows what the page size saves in address translation.
+template<class T>
+void benchmark_buffer_setup(size_t dataSize, ThreadPool& pool) {
+    std::cout << "\n=== Buffer Setup Analysis ===\n";
+    std::cout << std::left << std::setw(22) << "Buffer"
+              << std::setw(9) << "Fill"
+              << std::setw(13) << "Setup (ms)"
+              << std::setw(15) << "Setup Speedup"
+              << std::setw(18) << "Page Faults (K)"
+              << std::setw(13) << "Huge (MiB)"
+              << std::setw(11) << "Sum (ms)"
+              << std::setw(16) << "dTLB Miss (K)" << "\n";
+    std::cout << zen::repeat("-", 117) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    auto count_column = [](double count, double scale) {
+        std::ostringstream text;
+        if (count < 0)
+            text << "n/a";
+        else
+            text << std::fixed << std::setprecision(2) << count / scale;
+        return text.str();
+    };
+
+    double vectorSetup = 0;
+    auto row = [&](const std::string& buffer, bool parallel, auto&& make) {
+        decltype(make(0)) storage;
+        long long faults = page_faults();
+        double setup = measure_time([&]() {
+            storage = make(dataSize);
+            if (parallel)
+                fill_sequence_parallel(std::span<T>(storage), pool);
+            else
+                fill_sequence(std::span<T>(storage));
+        });
+        faults = faults < 0 ? -1 : page_faults() - faults;
+        if (vectorSetup == 0)
+            vectorSetup = setup;
+        std::span<const T> data(storage);
+
+        auto sum = sum_kernel<T, accumulator_t<T>>(SumKernel::Simd);
+        sum(data.data(), data.size());
+        PerfRegion region;
+        double sumTime = measure_time([&]() { sum(data.data(), data.size()); });
+        auto counts = region.stop();
+
+        std::cout << std::setw(22) << buffer
+                  << std::setw(9) << (parallel ? "pool" : "serial")
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(13) << setup
+                  << std::setw(15) << vectorSetup / setup
+                  << std::setw(18) << count_column(double(faults), 1e3)
+                  << std::setw(13) << count_column(huge_page_bytes(data.data(), data.size_bytes()), 1 << 20)
+                  << std::setw(11) << sumTime
+                  << std::setw(16) << count_column(counts[PerfDtlbMisses], 1e3) << "\n";
+    };
+
+    row("std::vector", false, [](size_t size) { return std::vector<T>(size); });
+    for (HugePages mode : {HugePages::Off, HugePages::Transparent, HugePages::Explicit}) {
+        for (bool parallel : {false, true}) {
+            row(std::string("pages, ") + to_string(mode), parallel,
+                [mode](size_t size) { return PageVector<T>(size, PageAllocator<T>(mode)); });
+        }
+    }
+}
+
+template<class T>
+void benchmark_workload_scaling(ThreadPool& pool, WorkStealingPool& stealingPool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Workload Scaling Analysis ===\n";
+    std::cout << std::left << std::setw(15) << "Data Size"
+              << std::setw(15) << "Threads (ms)"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(18) << "Async (ms)"
+              << std::setw(18) << "Fork-Join (ms)"
+              << std::setw(18) << "Speedup T/TP"
+              << std::setw(18) << "Speedup T/Async"
+              << std::setw(18) << "Speedup T/FJ"
+              << std::setw(12) << "GPU (ms)"
+              << std::setw(18) << "Speedup T/GPU" << "\n";
+    std::cout << zen::repeat("-", 166) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+
+    pool.resize(numThreads);
+    stealingPool.resize(numThreads);
+
+    std::vector<size_t> workloadSizes = {1000000, 5000000, 10000000, 50000000, 100000000};
+
+    for (size_t dataSize : workloadSizes) {
+        PlacedBuffer<T> testStorage(dataSize, pool);
+        std::span<const T> testData = testStorage.view();
+
+        // Regular threads
+        std::atomic<Acc> threadsTotal(0);
+        double threadsTime = measure_time([&]() {
+            atomic_sum(testData, threadsTotal, std::memory_order_relaxed, numThreads);
+        });
+
+        // ThreadPool
+        std::atomic<Acc> poolTotal(0);
+        double poolTime = measure_time([&]() {
+            threadpool_sum(testData, poolTotal, pool);
+        });
+
+        // Async
+        Acc asyncTotal = 0;
+        double asyncTime = measure_time([&]() {
+            asyncTotal = async_sum(testData, 0, testData.size());
+        });
+
+        // Fork-join on the work-stealing pool
+        Acc forkJoinTotal = 0;
+        double forkJoinTime = measure_time([&]() {
+            forkJoinTotal = fork_join_sum(testData, 0, testData.size(), stealingPool);
+        });
+
+        // GPU from pinned host memory, transfer included; the first call also sets up the device
+        double gpuTime = 0;
+        if (gpu_available()) {
+            GpuSumTiming timing;
+            gpu_pin_host(testData.data(), testData.size_bytes());
+            gpu_sum(testData, GpuInput::PinnedHost, timing);
+            gpuTime = measure_time([&]() { gpu_sum(testData, GpuInput::PinnedHost, timing); });
+            gpu_unpin_host(testData.data());
+        }
+
+        const std::tuple<const char*, const char*, double> points[] = {
+            {"Atomic Sum", "relaxed", threadsTime},
+            {"ThreadPool Sum", "N/A", poolTime},
+            {"Async Sum", "N/A", asyncTime},
+            {"Fork-Join Sum", "N/A", forkJoinTime},
+        };
+        for (const auto& [method, order, ms] : points)
+            record_result({element_type_name<T>(), method, order, "simd", numThreads, dataSize, 0, ms});
+        if (gpu_available())
+            record_result({element_type_name<T>(), "GPU Sum", "N/A", "gpu", numThreads, dataSize, 0, gpuTime});
+
+        double speedupTP = threadsTime / poolTime;
+        double speedupAsync = threadsTime / asyncTime;
+        double speedupForkJoin = threadsTime / forkJoinTime;
+
+        std::cout << std::setw(15) << dataSize
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(15) << threadsTime
+                  << std::setw(18) << poolTime
+                  << std::setw(18) << asyncTime
+                  << std::setw(18) << forkJoinTime
+                  << std::setw(18) << speedupTP
+                  << std::setw(18) << speedupAsync
+                  << std::setw(18) << speedupForkJoin;
+        if (gpu_available())
+            std::cout << std::setw(12) << gpuTime << std::setw(18) << threadsTime / gpuTime << "\n";
+        else
+            std::cout << std::setw(12) << "N/A" << std::setw(18) << "N/A" << "\n";
+    }
+}
+
+// Transfer and kernel time of the GPU block reduction against the ThreadPool, with the input
+// pinned in host memory (copied on every sum) and resident on the device (copied once)
+template<class T>
+void benchmark_gpu_offload(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== GPU Offload Analysis ===\n";
+    if (!gpu_available()) {
+#if defined(PARALLEL_SUM_CUDA)
+        std::cout << "GPU offload unavailable: no CUDA device\n";
+#else
+        std::cout << "GPU offload unavailable: built without -DPARALLEL_SUM_CUDA=ON\n";
+#endif
+        return;
+    }
+    std::cout << "Device: " << gpu_device_name() << "\n";
+    std::cout << std::left << std::setw(12) << "Size"
+              << std::setw(11) << "H2D (ms)"
+              << std::setw(14) << "Kernel (ms)"
+              << std::setw(14) << "Pinned (ms)"
+              << std::setw(16) << "Resident (ms)"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(15) << "Speedup TP/P"
+              << std::setw(15) << "Speedup TP/R" << "\n";
+    std::cout << zen::repeat("-", 115) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    gpu_pin_host(data.data(), data.size_bytes());
+    std::vector<size_t> sizes;
+    for (size_t size : {size_t(1000000), size_t(10000000), size_t(100000000)})
+        if (sizes.empty() || sizes.back() < data.size())
+            sizes.push_back(std::min(size, data.size()));
+
+    for (size_t size : sizes) {
+        std::span<const T> slice = data.first(size);
+        GpuSumTiming timing;
+        gpu_sum(slice, GpuInput::PinnedHost, timing);
+
+        double pinnedTime = measure_time([&]() { gpu_sum(slice, GpuInput::PinnedHost, timing); });
+        GpuSumTiming pinnedTiming = timing;
+        double residentTime = measure_time([&]() { gpu_sum(slice, GpuInput::DeviceResident, timing); });
+        std::atomic<Acc> poolTotal(0);
+        double poolTime = measure_time([&]() { threadpool_sum(slice, poolTotal, pool); });
+
+        std::cout << std::setw(12) << size
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(11) << pinnedTiming.transferMs
+                  << std::setw(14) << pinnedTiming.kernelMs
+                  << std::setw(14) << pinnedTime
+                  << std::setw(16) << residentTime
+                  << std::setw(18) << poolTime
+                  << std::setw(15) << poolTime / pinnedTime
+                  << std::setw(15) << poolTime / residentTime << "\n";
+    }
+    gpu_unpin_host(data.data());
+}
+
+// Compares the mutex-guarded ThreadPool queue against the work-stealing pool
+// as the number of tasks per sum grows
+template<class T>
+void benchmark_task_granularity(std::span<const T> data, ThreadPool& pool, WorkStealingPool& stealingPool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Task Granularity Analysis ===\n";
+    std::cout << std::left << std::setw(15) << "Tasks"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(22) << "Work-Stealing (ms)"
+              << std::setw(18) << "Speedup TP/WS" << "\n";
+    std::cout << zen::repeat("-", 73) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+
+    pool.resize(numThreads);
+    stealingPool.resize(numThreads);
+
+    std::vector<size_t> taskCounts = {1000, 10000, 100000};
+
+    for (size_t numTasks : taskCounts) {
+        std::atomic<Acc> poolTotal(0);
+        double poolTime = measure_time([&]() {
+            threadpool_sum(data, poolTotal, pool, SumKernel::Simd, numTasks);
+        });
+
+        std::atomic<Acc> stealingTotal(0);
+        double stealingTime = measure_time([&]() {
+            threadpool_sum(data, stealingTotal, stealingPool, SumKernel::Simd, numTasks);
+        });
+
+        std::cout << std::setw(15) << numTasks
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(18) << poolTime
+                  << std::setw(22) << stealingTime
+                  << std::setw(18) << poolTime / stealingTime << "\n";
+    }
+}
+
+// Compares static partitioning against the claiming schedules, once on an idle machine and once
+// with half the cores kept busy by spinning threads, which is when a static chunk waits on its
+// slowest worker
+template<class T>
+void benchmark_scheduling(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Chunk Scheduling Analysis ===\n";
+    std::cout << std::left << std::setw(18) << "Load"
+              << std::setw(12) << "Schedule"
+              << std::setw(14) << "Atomic (ms)"
+              << std::setw(21) << "Reduce Padded (ms)"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(18) << "TP vs Static" << "\n";
+    std::cout << zen::repeat("-", 101) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    // Warm the data and the pool so that the first row is not charged for it
+    std::atomic<Acc> warmTotal(0);
+    threadpool_sum(data, warmTotal, pool);
+
+    for (bool loaded : {false, true}) {
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> background;
+        if (loaded) {
+            for (unsigned int i = 0; i < std::max(numThreads / 2, 1u); ++i)
+                background.emplace_back([&stop]() {
+                    while (!stop.load(std::memory_order_relaxed))
+                        cpu_relax();
+                });
+        }
+
+        double staticTime = 0;
+        for (Schedule schedule : {Schedule::Static, Schedule::Dynamic, Schedule::Guided}) {
+            std::atomic<Acc> atomicTotal(0);
+            double atomicTime = measure_time([&]() {
+                atomic_sum(data, atomicTotal, std::memory_order_relaxed, numThreads, SumKernel::Simd, schedule);
+            });
+
+            std::vector<Acc> partialSums(numThreads, 0);
+            double reduceTime = measure_time([&]() {
+                reduce_sum(data, partialSums, numThreads, ReduceLayout::Padded, SumKernel::Simd, schedule);
+            });
+
+            std::atomic<Acc> poolTotal(0);
+            double poolTime = measure_time([&]() {
+                threadpool_sum(data, poolTotal, pool, SumKernel::Simd, 0, schedule);
+            });
+            if (schedule == Schedule::Static)
+                staticTime = poolTime;
+
+            std::string load = loaded ? std::to_string(background.size()) + " spinning" : "idle";
+            std::cout << std::setw(18) << load
+                      << std::setw(12) << to_string(schedule)
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(14) << atomicTime
+                      << std::setw(21) << reduceTime
+                      << std::setw(18) << poolTime
+                      << std::setw(18) << staticTime / poolTime << "\n";
+
+            std::string suffix = std::string(" (") + (loaded ? "loaded, " : "idle, ") + to_string(schedule) + ")";
+            record_result({element_type_name<T>(), "Atomic Sum" + suffix, "relaxed", "simd", numThreads,
+                           data.size(), 0, atomicTime});
+            record_result({element_type_name<T>(), "Reduce Padded" + suffix, "N/A", "simd", numThreads,
+                           data.size(), 0, reduceTime});
+            record_result({element_type_name<T>(), "ThreadPool" + suffix, "N/A", "simd", numThreads,
+                           data.size(), 0, poolTime});
+        }
+
+        stop = true;
+        for (auto& thread : background)
+            thread.join();
+    }
+}
+
+// Time from dispatching a sum to having its result, on inputs small enough that signalling
+// completion, rather than summing, is most of the cost. The mutex and condition variable
+// baseline is how the pool methods used to wait for their tasks.
+template<class T>
+void benchmark_dispatch_latency(std::span<const T> data, ThreadPool& pool, WorkStealingPool& stealingPool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Dispatch Latency Analysis ===\n";
+    std::cout << std::left << std::setw(12) << "Size"
+              << std::setw(18) << "TP Condvar (us)"
+              << std::setw(16) << "TP Latch (us)"
+              << std::setw(18) << "WS Condvar (us)"
+              << std::setw(16) << "WS Latch (us)"
+              << std::setw(18) << "Speedup TP C/L"
+              << std::setw(18) << "Speedup WS C/L" << "\n";
+    std::cout << zen::repeat("-", 116) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+    stealingPool.resize(numThreads);
+
+    SumKernelFn<T, Acc> sum = sum_kernel<T, Acc>(SumKernel::Simd);
+    auto condvar_sum = [sum](std::span<const T> input, std::atomic<Acc>& total, auto& taskPool) {
+        size_t numTasks = std::min(taskPool.size(), std::max<size_t>(input.size(), 1));
+        size_t chunk = input.size() / numTasks;
+        size_t completed_tasks = 0;
+        std::mutex completion_mutex;
+        std::condition_variable completion_cv;
+        for (size_t i = 0; i < numTasks; ++i) {
+            size_t start = i * chunk;
+            size_t end = (i == numTasks - 1) ? input.size() : start + chunk;
+            taskPool.enqueue([input, &total, start, end, sum, &completed_tasks, &completion_mutex, &completion_cv]() {
+                atomic_add(total, sum(input.data() + start, end - start), std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(completion_mutex);
+                ++completed_tasks;
+                completion_cv.notify_one();
+            });
+        }
+        std::unique_lock<std::mutex> lock(completion_mutex);
+        completion_cv.wait(lock, [&completed_tasks, numTasks]() { return completed_tasks >= numTasks; });
+    };
+
+    for (size_t size : {size_t(1) << 10, size_t(1) << 14, size_t(1) << 18}) {
+        std::span<const T> input = data.first(std::min(size, data.size()));
+        std::atomic<Acc> total(0);
+        auto best_of = [&](auto func) {
+            double us = std::numeric_limits<double>::infinity();
+            for (int r = 0; r < tuneRepetitions; ++r)
+                us = std::min(us, time_per_call(input.size(), func) * 1000.0);
+            return us;
+        };
+
+        double poolCondvar = best_of([&]() { condvar_sum(input, total, pool); });
+        double poolLatch = best_of([&]() { threadpool_sum(input, total, pool); });
+        double stealingCondvar = best_of([&]() { condvar_sum(input, total, stealingPool); });
+        double stealingLatch = best_of([&]() { threadpool_sum(input, total, stealingPool); });
+
+        std::cout << std::setw(12) << input.size()
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(18) << poolCondvar
+                  << std::setw(16) << poolLatch
+                  << std::setw(18) << stealingCondvar
+                  << std::setw(16) << stealingLatch
+                  << std::setw(18) << poolCondvar / poolLatch
+                  << std::setw(18) << stealingCondvar / stealingLatch << "\n";
+    }
+}
+
+// Heap allocations per threadpool_sum as the number of tasks grows. The ThreadPool queue holds
+// tasks inline in a ring, the work-stealing pool allocates each task it puts on a deque.
+template<class T>
+void benchmark_task_allocations(std::span<const T> data, ThreadPool& pool, WorkStealingPool& stealingPool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Task Allocation Analysis ===\n";
+    std::cout << std::left << std::setw(12) << "Tasks"
+              << std::setw(18) << "TP Allocs/Sum"
+              << std::setw(18) << "WS Allocs/Sum"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(22) << "Work-Stealing (ms)" << "\n";
+    std::cout << zen::repeat("-", 88) << "\n";
+    if (!countAllocations)
+        std::cout << "Allocation counting not built in: configure with -DPARALLEL_SUM_COUNT_ALLOCATIONS=ON\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+    stealingPool.resize(numThreads);
+
+    constexpr int sums = 10;
+    auto allocations_per_sum = [&](auto& taskPool, size_t numTasks, double& ms) {
+        std::atomic<Acc> total(0);
+        // The first sum grows the queue to its steady-state size
+        threadpool_sum(data, total, taskPool, SumKernel::Simd, numTasks);
+        uint64_t before = allocationCount.load(std::memory_order_relaxed);
+        ms = measure_time([&]() {
+            for (int s = 0; s < sums; ++s)
+                threadpool_sum(data, total, taskPool, SumKernel::Simd, numTasks);
+        }) / sums;
+        return double(allocationCount.load(std::memory_order_relaxed) - before) / sums;
+    };
+
+    auto allocations_column = [](double allocations) {
+        std::ostringstream text;
+        if (countAllocations)
+            text << std::fixed << std::setprecision(1) << allocations;
+        else
+            text << "N/A";
+        return text.str();
+    };
+
+    for (size_t numTasks : {size_t(numThreads), size_t(1000), size_t(10000), size_t(100000)}) {
+        double poolTime = 0, stealingTime = 0;
+        double poolAllocations = allocations_per_sum(pool, numTasks, poolTime);
+        double stealingAllocations = allocations_per_sum(stealingPool, numTasks, stealingTime);
+
+        std::cout << std::setw(12) << numTasks
+                  << std::setw(18) << allocations_column(poolAllocations)
+                  << std::setw(18) << allocations_column(stealingAllocations)
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(18) << poolTime
+                  << std::setw(22) << stealingTime << "\n";
+    }
+}
+
+// Many sums in flight on one pool at once. Blocking runs them back to back with threadpool_sum,
+// one dispatch and wait per sum; the coroutine sums are all started before any is waited for,
+// so their chunks share the pool. Cancelled requests a stop right after starting them.
+template<class T>
+void benchmark_async_throughput(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Coroutine Throughput Analysis ===\n";
+    std::cout << std::left << std::setw(14) << "Outstanding"
+              << std::setw(16) << "Blocking (ms)"
+              << std::setw(17) << "Coroutine (ms)"
+              << std::setw(16) << "Sums/s"
+              << std::setw(18) << "Speedup B/C"
+              << std::setw(16) << "Cancelled (ms)" << "\n";
+    std::cout << zen::repeat("-", 97) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    std::span<const T> slice = data.first(std::min<size_t>(data.size(), 1 << 18));
+    for (size_t outstanding : {1, 16, 256}) {
+        double blockingTime = measure_time([&]() {
+            for (size_t s = 0; s < outstanding; ++s) {
+                std::atomic<Acc> total(0);
+                threadpool_sum(slice, total, pool);
+            }
+        });
+
+        double coroutineTime = measure_time([&]() {
+            std::vector<AsyncTask<Acc>> sums;
+            for (size_t s = 0; s < outstanding; ++s)
+                sums.push_back(sum_async(slice, pool));
+            sync_wait_all(sums);
+        });
+
+        double cancelledTime = measure_time([&]() {
+            std::stop_source stop;
+            std::vector<AsyncTask<Acc>> sums;
+            for (size_t s = 0; s < outstanding; ++s)
+                sums.push_back(sum_async(slice, pool, stop.get_token()));
+            std::vector<std::optional<Acc>> results(outstanding);
+            std::vector<std::exception_ptr> errors(outstanding);
+            CompletionLatch latch(outstanding);
+            for (size_t s = 0; s < outstanding; ++s)
+                drive_task(sums[s], results[s], errors[s], latch);
+            stop.request_stop();
+            latch.wait();
+        });
+
+        std::cout << std::setw(14) << outstanding
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(16) << blockingTime
+                  << std::setw(17) << coroutineTime
+                  << std::setprecision(0)
+                  << std::setw(16) << outstanding / (coroutineTime / 1000.0)
+                  << std::setprecision(2)
+                  << std::setw(18) << blockingTime / coroutineTime
+                  << std::setw(16) << cancelledTime << "\n";
+    }
+}
+
+// Distribution of the timed runs of every method, with throughput at the median
+void print_timing_stats(const std::vector<std::pair<std::string, TimingStats>>& rows,
+                        size_t elements, size_t bytes) {
+    std::cout << "\n=== Timing Statistics (SIMD, " << warmupRuns << " warmup, "
+              << std::max(timedRuns, 1) << " timed runs) ===\n";
+    std::cout << std::left << std::setw(28) << "Method"
+              << std::setw(10) << "Outliers"
+              << std::setw(11) << "Min (ms)"
+              << std::setw(13) << "Median (ms)"
+              << std::setw(11) << "p90 (ms)"
+              << std::setw(11) << "p99 (ms)"
+              << std::setw(16) << "Mean 95% CI"
+              << std::setw(12) << "Gelem/s"
+              << std::setw(10) << "GB/s" << "\n";
+    std::cout << zen::repeat("-", 122) << "\n";
+    for (const auto& [method, stats] : rows) {
+        std::ostringstream interval;
+        interval << std::fixed << std::setprecision(2) << stats.mean << " +- " << stats.ci95;
+        std::cout << std::setw(28) << method
+                  << std::setw(10) << stats.outliers
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(11) << stats.min
+                  << std::setw(13) << stats.median
+                  << std::setw(11) << stats.p90
+                  << std::setw(11) << stats.p99
+                  << std::setw(16) << interval.str()
+                  << std::setw(12) << elements / (stats.median * 1e6)
+                  << std::setw(10) << bytes / (stats.median * 1e6) << "\n";
+    }
+}
+
+// Every method on the same data, timed with the scalar and the SIMD kernel (median of the timed
+// runs). withScan adds the Prefix Scan rows, whose output is as large as the input.
+template<class T>
+void benchmark_basic(std::span<const T> data, unsigned int numThreads,
+                     ThreadPool& pool, WorkStealingPool& stealingPool, bool withScan = true) {
+    using Acc = accumulator_t<T>;
+
+    pool.resize(numThreads);
+    stealingPool.resize(numThreads);
+
+    std::cout << "=== Basic Performance Comparison ===\n";
+    std::cout << std::left << std::setw(20) << "Method"
+              << std::setw(20) << "Memory Order"
+              << std::setw(20) << "Sum"
+              << std::setw(15) << "Scalar (ms)"
+              << std::setw(15) << "SIMD (ms)"
+              << std::setw(15) << "SIMD Speedup"
+              << std::setw(15) << "SIMD GB/s" << "\n";
+    std::cout << zen::repeat("-", 120) << "\n";
+
+    const SumKernel kernels[] = {SumKernel::Scalar, SumKernel::Simd};
+
+    // Every method is timed with measure_stats and shows its median; the SIMD statistics are
+    // printed in full after the table, and every run is recorded
+    std::vector<std::pair<std::string, TimingStats>> simdStats;
+    auto timed = [&](const std::string& method, const std::string& order, int k, auto&& func, auto&& reset) {
+        TimingStats stats = measure_stats(func, reset);
+        if (k == 1)
+            simdStats.emplace_back(order == "N/A" ? method : method + " (" + order + ")", stats);
+        for (size_t r = 0; r < stats.samples.size(); ++r) {
+            record_result({element_type_name<T>(), method, order, to_string(kernels[k]), numThreads,
+                           data.size(), static_cast<int>(r), stats.samples[r]});
+        }
+        return stats.median;
+    };
+    auto no_reset = []() {};
+
+    for (auto order : {std::memory_order_relaxed, std::memory_order_seq_cst}) {
+        std::string orderName = order == std::memory_order_relaxed ? "relaxed" : "seq_cst";
+        double times[2];
+        Acc sum = 0;
+        for (int k = 0; k < 2; ++k) {
+            std::atomic<Acc> total(0);
+            times[k] = timed("Atomic Sum", orderName, k, [&]() {
+                atomic_sum(data, total, order, numThreads, kernels[k]);
+            }, [&]() { total.store(0); });
+            sum = total.load();
+        }
+        print_result("Atomic Sum", orderName, sum, times[0], times[1], data.size_bytes());
+    }
+
+    for (auto layout : {ReduceLayout::Naive, ReduceLayout::Padded}) {
+        std::string method = layout == ReduceLayout::Naive ? "Reduce Sum" : "Reduce Sum (padded)";
+        double times[2];
+        Acc reduceResult = 0;
+        for (int k = 0; k < 2; ++k) {
+            std::vector<Acc> partialSums(numThreads, 0);
+            times[k] = timed(method, "N/A", k, [&]() {
+                reduce_sum(data, partialSums, numThreads, layout, kernels[k]);
+            }, [&]() { std::fill(partialSums.begin(), partialSums.end(), Acc(0)); });
+
+            reduceResult = 0;
+            for (auto sum : partialSums) {
+                reduceResult += sum;
+            }
+        }
+        print_result(method, "N/A", reduceResult, times[0], times[1], data.size_bytes());
+    }
+
+    // ThreadPool benchmark
+    double pool_times[2];
+    Acc poolResult = 0;
+    for (int k = 0; k < 2; ++k) {
+        std::atomic<Acc> poolTotal(0);
+        pool_times[k] = timed("ThreadPool Sum", "N/A", k, [&]() {
+            threadpool_sum(data, poolTotal, pool, kernels[k]);
+        }, [&]() { poolTotal.store(0); });
+        poolResult = poolTotal.load();
+    }
+    print_result("ThreadPool Sum", "N/A", poolResult, pool_times[0], pool_times[1], data.size_bytes());
+
+    // Work-stealing pool benchmark
+    double stealing_times[2];
+    Acc stealingResult = 0;
+    for (int k = 0; k < 2; ++k) {
+        std::atomic<Acc> stealingTotal(0);
+        stealing_times[k] = timed("Work-Stealing Sum", "N/A", k, [&]() {
+            threadpool_sum(data, stealingTotal, stealingPool, kernels[k]);
+        }, [&]() { stealingTotal.store(0); });
+        stealingResult = stealingTotal.load();
+    }
+    print_result("Work-Stealing Sum", "N/A", stealingResult, stealing_times[0], stealing_times[1], data.size_bytes());
+
+    double single_thread_times[2];
+    Acc singleThreadResult = 0;
+    for (int k = 0; k < 2; ++k) {
+        single_thread_times[k] = timed("Single-Threaded", "N/A", k, [&]() {
+            single_thread_sum(data, singleThreadResult, kernels[k]);
+        }, no_reset);
+    }
+    print_result("Single-Threaded", "N/A", singleThreadResult, single_thread_times[0], single_thread_times[1], data.size_bytes());
+
+    // Async benchmark
+    double async_times[2];
+    Acc asyncResult = 0;
+    for (int k = 0; k < 2; ++k) {
+        async_times[k] = timed("Async Sum", "N/A", k, [&]() {
+            asyncResult = async_sum(data, 0, data.size(), 100000, kernels[k]);
+        }, no_reset);
+    }
+    print_result("Async Sum", "N/A", asyncResult, async_times[0], async_times[1], data.size_bytes());
+
+    // Fork-join benchmark on the work-stealing pool
+    double fork_join_times[2];
+    Acc forkJoinResult = 0;
+    for (int k = 0; k < 2; ++k) {
+        fork_join_times[k] = timed("Fork-Join Sum", "N/A", k, [&]() {
+            forkJoinResult = fork_join_sum(data, 0, data.size(), stealingPool, 100000, kernels[k]);
+        }, no_reset);
+    }
+    print_result("Fork-Join Sum", "N/A", forkJoinResult, fork_join_times[0], fork_join_times[1], data.size_bytes());
+
+    // Deterministic block reduction on the ThreadPool
+    double deterministic_times[2];
+    Acc deterministicResult = 0;
+    for (int k = 0; k < 2; ++k) {
+        deterministic_times[k] = timed("Deterministic Sum", "N/A", k, [&]() {
+            deterministicResult = deterministic_sum(data, pool, kernels[k]);
+        }, no_reset);
+    }
+    print_result("Deterministic Sum", "N/A", deterministicResult, deterministic_times[0], deterministic_times[1], data.size_bytes());
+
+    // Two-pass prefix scan on the ThreadPool; the sum is the total it returns
+    std::vector<Acc> prefix(withScan ? data.size() : 0);
+    for (auto kind : {ScanKind::Inclusive, ScanKind::Exclusive}) {
+        if (!withScan)
+            break;
+        double scan_times[2];
+        Acc scanResult = 0;
+        for (int k = 0; k < 2; ++k) {
+            scan_times[k] = timed("Prefix Scan", to_string(kind), k, [&]() {
+                scanResult = scan_sum(data, std::span<Acc>(prefix), pool, kind, kernels[k]);
+            }, no_reset);
+        }
+        print_result("Prefix Scan", to_string(kind), scanResult, scan_times[0], scan_times[1], data.size_bytes());
+    }
+
+    print_timing_stats(simdStats, data.size(), data.size_bytes());
+}
+
+// Values of mixed sign spread over eight orders of magnitude, so that naive summation visibly
+// loses precision and its result depends on how the input is split
+template<class T>
+void fill_random(std::vector<T>& data, unsigned int seed = 42) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_real_distribution<double> exponent(-4.0, 4.0);
+    for (auto& x : data)
+        x = static_cast<T>(mantissa(rng) * std::pow(10.0, exponent(rng)));
+}
+
+// Near-exact reference: sequential Neumaier summation in long double
+template<class T>
+long double reference_sum(std::span<const T> data) {
+    long double sum = 0, comp = 0;
+    for (T x : data)
+        neumaier_add(sum, comp, static_cast<long double>(x));
+    return sum + comp;
+}
+
+void print_accuracy_result(const std::string& method, const std::string& accumulator, SumKernel kernel,
+                           double sum, long double reference, double timeMs) {
+    long double relError = reference != 0 ? std::abs((sum - reference) / reference) : std::abs(sum - reference);
+    std::cout << std::setw(20) << method
+              << std::setw(14) << accumulator
+              << std::setw(12) << to_string(kernel)
+              << std::scientific << std::setprecision(10) << std::setw(22) << sum
+              << std::setprecision(2) << std::setw(14) << static_cast<double>(relError)
+              << std::fixed << std::setw(12) << timeMs << "\n";
+}
+
+template<class T, class Acc>
+void benchmark_accuracy_rows(std::span<const T> data, long double reference, const std::string& accumulator,
+                             ThreadPool& pool, WorkStealingPool& stealingPool) {
+    for (SumKernel kernel : {SumKernel::Scalar, SumKernel::Simd, SumKernel::Kahan,
+                             SumKernel::Neumaier, SumKernel::Pairwise}) {
+        Acc singleResult = 0;
+        double singleTime = measure_time([&]() {
+            single_thread_sum(data, singleResult, kernel);
+        });
+        print_accuracy_result("Single-Threaded", accumulator, kernel, singleResult, reference, singleTime);
+
+        std::atomic<Acc> poolTotal(0);
+        double poolTime = measure_time([&]() {
+            threadpool_sum(data, poolTotal, pool, kernel);
+        });
+        print_accuracy_result("ThreadPool Sum", accumulator, kernel, poolTotal.load(), reference, poolTime);
+
+        Acc forkJoinResult = 0;
+        double forkJoinTime = measure_time([&]() {
+            forkJoinResult = fork_join_sum<T, Acc>(data, 0, data.size(), stealingPool, 100000, kernel);
+        });
+        print_accuracy_result("Fork-Join Sum", accumulator, kernel, forkJoinResult, reference, forkJoinTime);
+
+        Acc deterministicResult = 0;
+        double deterministicTime = measure_time([&]() {
+            deterministicResult = deterministic_sum<T, Acc>(data, pool, kernel);
+        });
+        print_accuracy_result("Deterministic Sum", accumulator, kernel, deterministicResult, reference,
+                              deterministicTime);
+    }
+}
+
+// Sums the same data on a growing number of threads: the ThreadPool result may change with the
+// thread count (for floating point), the deterministic one must not
+template<class T>
+void benchmark_determinism(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Deterministic Reduction Analysis ===\n";
+    std::cout << std::left << std::setw(10) << "Threads"
+              << std::setw(26) << "ThreadPool Sum"
+              << std::setw(26) << "Deterministic Sum"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(22) << "Deterministic (ms)"
+              << std::setw(12) << "Overhead" << "\n";
+    std::cout << zen::repeat("-", 114) << "\n";
+
+    // Oversubscribed counts are kept on purpose: the point is that the result does not move
+    std::vector<unsigned int> threadCounts = {1, 2, 4, 8, 16};
+    unsigned int maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads > 16) {
+        threadCounts.push_back(maxThreads);
+    }
+
+    size_t originalSize = pool.size();
+    Acc firstDeterministic = 0;
+    bool stable = true;
+
+    for (unsigned int numThreads : threadCounts) {
+        pool.resize(numThreads);
+
+        std::atomic<Acc> poolTotal(0);
+        double poolTime = measure_time([&]() {
+            threadpool_sum(data, poolTotal, pool);
+        });
+
+        Acc deterministicResult = 0;
+        double deterministicTime = measure_time([&]() {
+            deterministicResult = deterministic_sum(data, pool);
+        });
+
+        if (numThreads == threadCounts.front())
+            firstDeterministic = deterministicResult;
+        stable = stable && deterministicResult == firstDeterministic;
+
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setw(10) << numThreads
+                  << std::setprecision(std::numeric_limits<Acc>::max_digits10)
+                  << std::setw(26) << poolTotal.load()
+                  << std::setw(26) << deterministicResult
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(18) << poolTime
+                  << std::setw(22) << deterministicTime
+                  << std::setw(12) << deterministicTime / poolTime << "\n";
+    }
+
+    std::cout << "Deterministic result " << (stable ? "identical" : "DIFFERS") << " across thread counts\n";
+    std::cout << std::fixed;
+    pool.resize(originalSize);
+}
+
+// Error of every summation mode against the long double reference, next to its time cost,
+// with the element type itself and with the default wider type as the accumulator
+template<class T>
+void benchmark_float_accuracy(const std::string& typeName, std::span<const T> data,
+                              ThreadPool& pool, WorkStealingPool& stealingPool) {
+    long double reference = reference_sum(data);
+
+    std::cout << "\n=== Floating-Point Accuracy Analysis ===\n";
+    std::cout << "Reference (long double): " << std::scientific << std::setprecision(10)
+              << static_cast<double>(reference) << std::fixed << "\n";
+    std::cout << std::left << std::setw(20) << "Method"
+              << std::setw(14) << "Accumulator"
+              << std::setw(12) << "Mode"
+              << std::setw(22) << "Sum"
+              << std::setw(14) << "Rel Error"
+              << std::setw(12) << "Time (ms)" << "\n";
+    std::cout << zen::repeat("-", 94) << "\n";
+
+    if constexpr (!std::is_same_v<T, accumulator_t<T>>)
+        benchmark_accuracy_rows<T, T>(data, reference, typeName, pool, stealingPool);
+    benchmark_accuracy_rows<T, accumulator_t<T>>(data, reference, "double", pool, stealingPool);
+}
+
+// Appends, point updates and range queries on RunningSum against rescanning the data for every
+// answer; times are per operation, as the rescans can only afford a few operations
+template<class T>
+void benchmark_incremental(std::span<const T> data) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Incremental Sum Analysis ===\n";
+    std::cout << std::left << std::setw(22) << "Operation"
+              << std::setw(10) << "Ops"
+              << std::setw(18) << "Rescan (us/op)"
+              << std::setw(18) << "Blocks (us/op)"
+              << std::setw(18) << "Fenwick (us/op)"
+              << std::setw(18) << "Speedup R/F" << "\n";
+    std::cout << zen::repeat("-", 104) << "\n";
+
+    const size_t appendOps = 100;
+    const size_t updateOps = 10000;
+    const size_t queryOps = 10000;
+    const size_t rescanOps = 20;
+    size_t batch = std::max<size_t>(data.size() / appendOps, 1);
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> position(0, data.size() - 1);
+    std::vector<std::pair<size_t, size_t>> updates(updateOps), ranges(queryOps);
+    for (auto& [target, source] : updates)
+        target = position(rng), source = position(rng);
+    for (auto& [start, end] : ranges) {
+        start = position(rng), end = position(rng);
+        if (start > end)
+            std::swap(start, end);
+    }
+
+    // Rescan: keep a plain vector and sum all of it (or the queried range) for every answer
+    double rescan[3];
+    {
+        std::vector<T> values;
+        volatile Acc sink = 0;
+        rescan[0] = measure_time([&]() {
+            for (size_t offset = 0; offset < data.size(); offset += batch) {
+                auto next = data.subspan(offset, std::min(batch, data.size() - offset));
+                values.insert(values.end(), next.begin(), next.end());
+                Acc total;
+                single_thread_sum<T, Acc>(values, total);
+                sink = total;
+            }
+        }) * 1000.0 / ((data.size() + batch - 1) / batch);
+        rescan[1] = measure_time([&]() {
+            for (size_t i = 0; i < rescanOps; ++i) {
+                values[updates[i].first] = data[updates[i].second];
+                Acc total;
+                single_thread_sum<T, Acc>(values, total);
+                sink = total;
+            }
+        }) * 1000.0 / rescanOps;
+        rescan[2] = measure_time([&]() {
+            for (size_t i = 0; i < rescanOps; ++i) {
+                auto [start, end] = ranges[i];
+                Acc total;
+                single_thread_sum<T, Acc>(std::span<const T>(values).subspan(start, end - start), total);
+                sink = total;
+            }
+        }) * 1000.0 / rescanOps;
+    }
+
+    auto run = [&](RangeIndex index, double* times) {
+        RunningSum<T> running(index);
+        volatile Acc sink = 0;
+        times[0] = measure_time([&]() {
+            for (size_t offset = 0; offset < data.size(); offset += batch) {
+                running.append(data.subspan(offset, std::min(batch, data.size() - offset)));
+                sink = running.total();
+            }
+        }) * 1000.0 / ((data.size() + batch - 1) / batch);
+        times[1] = measure_time([&]() {
+            for (auto [target, source] : updates) {
+                running.update(target, data[source]);
+                sink = running.total();
+            }
+        }) * 1000.0 / updateOps;
+        times[2] = measure_time([&]() {
+            for (auto [start, end] : ranges)
+                sink = running.range_sum(start, end);
+        }) * 1000.0 / queryOps;
+    };
+    double blocks[3], fenwick[3];
+    run(RangeIndex::Blocks, blocks);
+    run(RangeIndex::Fenwick, fenwick);
+
+    const char* operations[] = {"Append + total", "Update + total", "Range sum"};
+    const size_t ops[] = {(data.size() + batch - 1) / batch, updateOps, queryOps};
+    for (int i = 0; i < 3; ++i) {
+        std::cout << std::setw(22) << operations[i]
+                  << std::setw(10) << ops[i]
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(18) << rescan[i]
+                  << std::setw(18) << blocks[i]
+                  << std::setw(18) << fenwick[i]
+                  << std::setw(18) << rescan[i] / fenwick[i] << "\n";
+    }
+}
+
+// One fused pass over the configured statistics against one pass per statistic, all relative to
+// the plain sum kernel, serially and on the ThreadPool
+template<class T>
+void benchmark_aggregate(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Aggregate Analysis ===\n";
+    std::cout << "Statistics: " << stats_name(aggregateStats) << "\n";
+    std::cout << std::left << std::setw(24) << "Pass"
+              << std::setw(14) << "Serial (ms)"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(16) << "Serial / Sum"
+              << std::setw(16) << "TP / Sum" << "\n";
+    std::cout << zen::repeat("-", 88) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    auto best_time = [](auto&& func) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < tuneRepetitions; ++r)
+            best = std::min(best, measure_time(func));
+        return best;
+    };
+    volatile Acc sink = 0;
+    double sumSerial = best_time([&]() {
+        Acc total;
+        single_thread_sum(data, total);
+        sink = total;
+    });
+    double sumPool = best_time([&]() {
+        std::atomic<Acc> total(0);
+        threadpool_sum(data, total, pool);
+        sink = total.load();
+    });
+
+    auto print_row = [&](const std::string& pass, double serial, double pooled) {
+        std::cout << std::setw(24) << pass
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(14) << serial
+                  << std::setw(18) << pooled
+                  << std::setw(16) << serial / sumSerial
+                  << std::setw(16) << pooled / sumPool << "\n";
+    };
+    print_row("sum kernel", sumSerial, sumPool);
+
+    Aggregate<T, Acc> result;
+    auto time_stats = [&](unsigned int stats, double& serial, double& pooled) {
+        serial = best_time([&]() { result = aggregate(data, stats); });
+        pooled = best_time([&]() { result = aggregate(data, pool, stats); });
+    };
+    double separateSerial = 0, separatePool = 0;
+    for (auto [stat, statName] : statNames) {
+        if (!(aggregateStats & stat))
+            continue;
+        double serial, pooled;
+        time_stats(stat, serial, pooled);
+        print_row(statName, serial, pooled);
+        separateSerial += serial;
+        separatePool += pooled;
+    }
+    print_row("separate passes", separateSerial, separatePool);
+    double fusedSerial, fusedPool;
+    time_stats(aggregateStats, fusedSerial, fusedPool);
+    print_row("fused", fusedSerial, fusedPool);
+
+    std::cout << "Count: " << result.count;
+    if (aggregateStats & statSum)
+        std::cout << ", Sum: " << result.sum << ", Mean: " << result.mean();
+    if (aggregateStats & statMin)
+        std::cout << ", Min: " << +result.min;
+    if (aggregateStats & statMax)
+        std::cout << ", Max: " << +result.max;
+    if ((aggregateStats & statSum) && (aggregateStats & statSumSquares))
+        std::cout << ", Variance: " << result.variance();
+    std::cout << "\n";
+}
+
+// Masked sums across selectivity and group-by sums across key cardinality, on the first
+// predicatedElements elements, so that the std::unordered_map baseline stays short
+constexpr size_t predicatedElements = size_t(1) << 24;
+
+template<class T>
+void benchmark_predicated(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    data = data.first(std::min(data.size(), predicatedElements));
+    auto best_time = [](auto&& func) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < tuneRepetitions; ++r)
+            best = std::min(best, measure_time(func));
+        return best;
+    };
+    std::mt19937_64 rng(42);
+    volatile Acc sink = 0;
+
+    std::cout << "\n=== Masked Sum Analysis ===\n";
+    std::cout << std::left << std::setw(14) << "Selectivity"
+              << std::setw(16) << "Byte Mask (ms)"
+              << std::setw(14) << "Bitmap (ms)"
+              << std::setw(16) << "Bytes TP (ms)"
+              << std::setw(17) << "Bitmap TP (ms)"
+              << std::setw(14) << "Sum TP (ms)"
+              << std::setw(16) << "Bitmap TP/Sum"
+              << std::setw(8) << "Exact" << "\n";
+    std::cout << zen::repeat("-", 115) << "\n";
+
+    double sumPoolTime = best_time([&]() {
+        std::atomic<Acc> total(0);
+        threadpool_sum(data, total, pool);
+        sink = total.load();
+    });
+    std::vector<uint8_t> mask(data.size());
+    std::vector<uint64_t> bitmap(mask_size<uint64_t>(data.size()));
+    for (double selectivity : {0.01, 0.1, 0.5, 0.9, 0.99}) {
+        std::bernoulli_distribution select(selectivity);
+        std::fill(bitmap.begin(), bitmap.end(), 0);
+        Acc expected = 0;
+        for (size_t i = 0; i < data.size(); ++i) {
+            mask[i] = select(rng);
+            bitmap[i / 64] |= uint64_t(mask[i]) << (i % 64);
+            if (mask[i])
+                expected += static_cast<Acc>(data[i]);
+        }
+        std::span<const uint8_t> bytes = mask;
+        std::span<const uint64_t> bits = bitmap;
+
+        Acc results[4];
+        double times[4] = {
+            best_time([&]() { sink = results[0] = masked_sum(data, bytes); }),
+            best_time([&]() { sink = results[1] = masked_sum(data, bits); }),
+            best_time([&]() { sink = results[2] = masked_sum(data, bytes, pool); }),
+            best_time([&]() { sink = results[3] = masked_sum(data, bits, pool); }),
+        };
+        bool exact = std::all_of(std::begin(results), std::end(results), [&](Acc r) { return r == expected; });
+
+        std::cout << std::setw(14) << (std::to_string(int(selectivity * 100)) + "%")
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(16) << times[0]
+                  << std::setw(14) << times[1]
+                  << std::setw(16) << times[2]
+                  << std::setw(17) << times[3]
+                  << std::setw(14) << sumPoolTime
+                  << std::setw(16) << times[3] / sumPoolTime
+                  << std::setw(8) << (exact ? "yes" : "NO") << "\n";
+    }
+
+    std::cout << "\n=== Group-By Sum Analysis ===\n";
+    std::cout << std::left << std::setw(12) << "Keys"
+              << std::setw(14) << "Table"
+              << std::setw(22) << "unordered_map (ms)"
+              << std::setw(18) << "1 Thread (ms)"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(15) << "Speedup U/TP"
+              << std::setw(8) << "Exact" << "\n";
+    std::cout << zen::repeat("-", 107) << "\n";
+
+    // Every cardinality with the key bound, and the larger ones also without, on hash tables
+    std::vector<uint32_t> keys(data.size());
+    for (auto [numKeys, bounded] : {std::pair(size_t(16), true), std::pair(size_t(1024), true),
+                                    std::pair(size_t(16384), true), std::pair(size_t(16384), false),
+                                    std::pair(size_t(1) << 20, true), std::pair(size_t(1) << 20, false),
+                                    std::pair(size_t(1) << 24, true), std::pair(size_t(1) << 24, false)}) {
+        std::uniform_int_distribution<uint32_t> key(0, static_cast<uint32_t>(numKeys - 1));
+        for (uint32_t& k : keys)
+            k = key(rng);
+        std::span<const uint32_t> keyView = keys;
+        size_t bound = bounded ? numKeys : 0;
+
+        std::unordered_map<uint32_t, std::pair<Acc, size_t>> map;
+        double mapTime = best_time([&]() {
+            map.clear();
+            for (size_t i = 0; i < data.size(); ++i) {
+                auto& [sum, count] = map[keys[i]];
+                sum += static_cast<Acc>(data[i]);
+                ++count;
+            }
+        });
+        std::vector<GroupSum<Acc>> groups;
+        pool.resize(1);
+        double serialTime = best_time([&]() { groups = group_sum(data, keyView, pool, bound); });
+        pool.resize(numThreads);
+        double poolTime = best_time([&]() { groups = group_sum(data, keyView, pool, bound); });
+
+        bool exact = groups.size() == map.size() && std::all_of(groups.begin(), groups.end(), [&](const auto& group) {
+            auto it = map.find(group.key);
+            return it != map.end() && it->second.first == group.sum && it->second.second == group.count;
+        });
+
+        std::cout << std::setw(12) << numKeys
+                  << std::setw(14) << to_string(group_table_for<Acc>(bound))
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(22) << mapTime
+                  << std::setw(18) << serialTime
+                  << std::setw(18) << poolTime
+                  << std::setw(15) << mapTime / poolTime
+                  << std::setw(8) << (exact ? "yes" : "NO") << "\n";
+    }
+}
+
+// Cost of every accumulator policy against the wrapping sum. For int64 two more inputs of
+// predicatedElements elements exercise the other paths: values of +-2^62 in the two halves of
+// every block, which overflow the lanes but sum to zero, and values of 2^62, whose sum does not
+// fit 64 bits at all.
+template<class T>
+void benchmark_accumulator_policies(std::span<const T> data, ThreadPool& pool) {
+    std::cout << "\n=== Accumulator Policy Analysis ===\n";
+    std::cout << std::left << std::setw(16) << "Input"
+              << std::setw(13) << "Policy"
+              << std::setw(14) << "Serial (ms)"
+              << std::setw(18) << "ThreadPool (ms)"
+              << std::setw(13) << "TP / Wrap"
+              << "Sum" << "\n";
+    std::cout << zen::repeat("-", 100) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    auto best_time = [](auto&& func) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < tuneRepetitions; ++r)
+            best = std::min(best, measure_time(func));
+        return best;
+    };
+
+    auto run = [&](const std::string& input, std::span<const T> values) {
+        double wrapPool = 0;
+        auto row = [&]<class Policy>(const char* name, Policy) {
+            // An untimed call gives the result, so only the policy call itself is timed. Where it
+            // throws SumOverflow, the timed calls still have to catch it; the throw is part of the
+            // checked policy's cost.
+            std::string result = "SumOverflow";
+            bool overflows = false;
+            try {
+                std::ostringstream text;
+                text << policy_sum<Policy>(values);
+                result = text.str();
+            } catch (const SumOverflow&) {
+                overflows = true;
+            }
+            typename Policy::template result_type<T> value{};
+            auto sum = [&](auto&& func) {
+                if (!overflows) {
+                    value = func();
+                    return;
+                }
+                try {
+                    value = func();
+                } catch (const SumOverflow&) {
+                }
+            };
+            double serial = best_time([&]() { sum([&]() { return policy_sum<Policy>(values); }); });
+            double pooled = best_time([&]() { sum([&]() { return policy_sum<Policy>(values, pool); }); });
+            if (std::is_same_v<Policy, WrapPolicy>)
+                wrapPool = pooled;
+            std::cout << std::setw(16) << input
+                      << std::setw(13) << name
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(14) << serial
+                      << std::setw(18) << pooled
+                      << std::setw(13) << pooled / wrapPool
+                      << result << "\n";
+        };
+        row("wrap", WrapPolicy{});
+        row("checked", CheckedPolicy{});
+        row("saturating", SaturatingPolicy{});
+        row("wide", WidePolicy{});
+    };
+
+    run("in range", data);
+    if constexpr (std::is_same_v<T, int64_t>) {
+        std::vector<T> values(std::min(data.size(), predicatedElements));
+        const T big = T(1) << 62;
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] = i % checkedBlockSize < checkedBlockSize / 2 ? big : -big;
+        if (values.size() % checkedBlockSize != 0) {
+            // Balance the partial last block, so that the total stays zero
+            size_t last = values.size() / checkedBlockSize * checkedBlockSize;
+            for (size_t i = last; i < values.size(); ++i)
+                values[i] = (i - last) % 2 == 0 ? big : -big;
+            if ((values.size() - last) % 2 != 0)
+                values.back() = 0;
+        }
+        run("lane overflow", values);
+        std::fill(values.begin(), values.end(), big);
+        run("overflow", values);
+    }
+}
+
+// Sums over encoded int32 columns against decoding into a buffer and summing that, and against
+// summing the plain column. Every encoding gets data it suits: 12-bit values, values within
+// 1024 of a slowly rising base, and a timestamp-like sequence rising by 0 to 15 per value.
+void benchmark_encoded(size_t size, ThreadPool& pool) {
+    std::cout << "\n=== Encoded Input Analysis ===\n";
+    std::cout << std::left << std::setw(15) << "Encoding"
+              << std::setw(8) << "Bits"
+              << std::setw(8) << "Ratio"
+              << std::setw(13) << "Plain (ms)"
+              << std::setw(16) << "Decode+Sum (ms)"
+              << std::setw(15) << "Encoded (ms)"
+              << std::setw(16) << "Plain TP (ms)"
+              << std::setw(18) << "Encoded TP (ms)"
+              << std::setw(14) << "Speedup D/E"
+              << std::setw(15) << "Speedup P/E"
+              << std::setw(8) << "Exact" << "\n";
+    std::cout << zen::repeat("-", 146) << "\n";
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+        numThreads = 4;
+    pool.resize(numThreads);
+
+    std::vector<int32_t> values(size), decoded(size);
+    std::mt19937_64 rng(42);
+    auto best_time = [&](auto&& func) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < tuneRepetitions; ++r)
+            best = std::min(best, time_per_call(size, func));
+        return best;
+    };
+
+    for (Encoding encoding : {Encoding::BitPacked, Encoding::FrameOfReference, Encoding::Delta}) {
+        if (encoding == Encoding::BitPacked) {
+            std::uniform_int_distribution<int32_t> value(0, 4095);
+            for (int32_t& x : values)
+                x = value(rng);
+        } else if (encoding == Encoding::FrameOfReference) {
+            std::uniform_int_distribution<int32_t> noise(0, 1023);
+            for (size_t i = 0; i < size; ++i)
+                values[i] = 1000000000 + static_cast<int32_t>(i / 4096 % 1000000) + noise(rng);
+        } else {
+            std::uniform_int_distribution<int32_t> step(0, 15);
+            int32_t time = 0;
+            for (int32_t& x : values) {
+                x = time;
+                time = time <= std::numeric_limits<int32_t>::max() - 15 ? time + step(rng) : 0;
+            }
+        }
+        std::span<const int32_t> plain = values;
+        EncodedColumn column = encode_column(plain, encoding);
+
+        long long plainSum = 0, encodedSum = 0, encodedPoolSum = 0, decodedSum = 0;
+        volatile long long sink = 0;
+        double plainTime = best_time([&]() {
+            single_thread_sum<int32_t, long long>(plain, plainSum);
+            sink = plainSum;
+        });
+        double decodeTime = best_time([&]() {
+            decode_column(column, decoded);
+            single_thread_sum<int32_t, long long>(decoded, decodedSum);
+            sink = decodedSum;
+        });
+        double encodedTime = best_time([&]() { sink = encodedSum = encoded_sum(column); });
+        double plainPoolTime = best_time([&]() {
+            std::atomic<long long> total(0);
+            threadpool_sum(plain, total, pool);
+            sink = total.load();
+        });
+        double encodedPoolTime = best_time([&]() { sink = encodedPoolSum = encoded_sum(column, pool); });
+        bool exact = encodedSum == plainSum && encodedPoolSum == plainSum && decodedSum == plainSum;
+
+        std::cout << std::setw(15) << to_string(encoding)
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(8) << column.words.size() * 32.0 / std::max<size_t>(size, 1)
+                  << std::setw(8) << double(plain.size_bytes()) / std::max<size_t>(column.bytes(), 1)
+                  << std::setw(13) << plainTime
+                  << std::setw(16) << decodeTime
+                  << std::setw(15) << encodedTime
+                  << std::setw(16) << plainPoolTime
+                  << std::setw(18) << encodedPoolTime
+                  << std::setw(14) << decodeTime / encodedTime
+                  << std::setw(15) << plainPoolTime / encodedPoolTime
+                  << std::setw(8) << (exact ? "yes" : "NO") << "\n";
+    }
+}
+
+// Thousands of small arrays per request: one ThreadPool dispatch per array, a sequential loop,
+// and sum_batch, over several array-size distributions. The arrays are slices of the data.
+template<class T>
+void benchmark_batch(std::span<const T> data, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Batched Summation Analysis ===\n";
+    std::cout << std::left << std::setw(18) << "Array Sizes"
+              << std::setw(10) << "Arrays"
+              << std::setw(15) << "Elements"
+              << std::setw(20) << "Per-Array TP (ms)"
+              << std::setw(18) << "Sequential (ms)"
+              << std::setw(15) << "Batch (ms)"
+              << std::setw(18) << "Speedup TP/B"
+              << std::setw(18) << "Speedup Seq/B" << "\n";
+    std::cout << zen::repeat("-", 132) << "\n";
+
+    struct Distribution {
+        const char* name;
+        size_t minSize, maxSize;
+    };
+    const Distribution distributions[] = {
+        {"1k", 1000, 1000},
+        {"10k", 10000, 10000},
+        {"100k", 100000, 100000},
+        {"1k-100k log", 1000, 100000},
+    };
+    const size_t numArrays = 4096;
+
+    std::mt19937_64 rng(42);
+    for (const auto& distribution : distributions) {
+        if (distribution.maxSize > data.size())
+            continue;
+
+        // Log-uniform sizes, so that every decade gets about the same number of arrays
+        std::uniform_real_distribution<double> logSize(std::log(double(distribution.minSize)),
+                                                       std::log(double(distribution.maxSize)));
+        std::vector<std::span<const T>> arrays(numArrays);
+        size_t elements = 0;
+        for (auto& array : arrays) {
+            size_t size = std::clamp<size_t>(size_t(std::exp(logSize(rng))), distribution.minSize, distribution.maxSize);
+            size_t offset = std::uniform_int_distribution<size_t>(0, data.size() - size)(rng);
+            array = data.subspan(offset, size);
+            elements += size;
+        }
+
+        std::vector<Acc> poolTotals(numArrays);
+        double poolTime = measure_time([&]() {
+            for (size_t i = 0; i < numArrays; ++i) {
+                std::atomic<Acc> total(0);
+                threadpool_sum(arrays[i], total, pool);
+                poolTotals[i] = total.load();
+            }
+        });
+
+        std::vector<Acc> sequentialTotals(numArrays);
+        double sequentialTime = measure_time([&]() {
+            for (size_t i = 0; i < numArrays; ++i)
+                single_thread_sum(arrays[i], sequentialTotals[i]);
+        });
+
+        std::vector<Acc> batchTotals;
+        double batchTime = measure_time([&]() {
+            batchTotals = sum_batch<T>(arrays, pool);
+        });
+
+        std::cout << std::setw(18) << distribution.name
+                  << std::setw(10) << numArrays
+                  << std::setw(15) << elements
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(20) << poolTime
+                  << std::setw(18) << sequentialTime
+                  << std::setw(15) << batchTime
+                  << std::setw(18) << poolTime / batchTime
+                  << std::setw(18) << sequentialTime / batchTime << "\n";
+    }
+}
+
+// The tuned profile, then auto_sum against the default ThreadPool split over every worker, at the
+// upper bound of every bucket and at the size of the data; times are per call
+template<class T>
+void benchmark_autotune(std::span<const T> data, AutoTuner& tuner, ThreadPool& pool) {
+    using Acc = accumulator_t<T>;
+
+    const auto& choices = tuner.profile<T>();
+    pool.resize(std::max<unsigned int>(std::thread::hardware_concurrency(), 1));
+
+    std::cout << "\n=== Autotuner Profile ===\n";
+    std::cout << std::left << std::setw(15) << "Elements"
+              << std::setw(13) << "Method"
+              << std::setw(10) << "Threads"
+              << std::setw(10) << "Grain"
+              << std::setw(18) << "Calibrated (us)"
+              << std::setw(16) << "Auto Sum (us)"
+              << std::setw(18) << "ThreadPool (us)"
+              << std::setw(18) << "Speedup TP/Auto" << "\n";
+    std::cout << zen::repeat("-", 118) << "\n";
+
+    std::vector<size_t> sizes;
+    for (const auto& choice : choices)
+        sizes.push_back(std::min(choice.maxSize, data.size()));
+    sizes.push_back(data.size());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+    for (size_t size : sizes) {
+        std::span<const T> slice = data.first(size);
+        const TunedChoice& choice = tuner.choose<T>(size);
+        // Best of a few runs, as in calibration, so that neither side pays for a cold cache alone
+        volatile Acc sink = 0;
+        auto pool_sum = [&]() {
+            std::atomic<Acc> poolTotal(0);
+            threadpool_sum(slice, poolTotal, pool);
+            sink = poolTotal.load();
+        };
+        double autoTime = std::numeric_limits<double>::infinity();
+        double poolTime = std::numeric_limits<double>::infinity();
+        for (int r = 0; r < tuneRepetitions; ++r) {
+            autoTime = std::min(autoTime, time_per_call(size, [&]() { sink = auto_sum(slice, tuner); }));
+            poolTime = std::min(poolTime, time_per_call(size, pool_sum));
+        }
+
+        std::cout << std::setw(15) << size
+                  << std::setw(13) << to_string(choice.method)
+                  << std::setw(10) << (choice.method == TunedMethod::ThreadPool ? std::to_string(choice.threads) : "-")
+                  << std::setw(10) << (choice.method == TunedMethod::ForkJoin ? std::to_string(choice.grain) : "-")
+                  << std::fixed << std::setprecision(2);
+        if (choice.ms >= 0 && size == choice.maxSize)
+            std::cout << std::setw(18) << choice.ms * 1000.0;
+        else
+            std::cout << std::setw(18) << (choice.ms >= 0 ? "-" : "cached");
+        std::cout << std::setw(16) << autoTime * 1000.0
+                  << std::setw(18) << poolTime * 1000.0
+                  << std::setw(18) << poolTime / autoTime << "\n";
+    }
+}
+
+// Hardware counters per method and thread count, for the methods whose threads the counters see.
+// Mem GB/s estimates memory traffic as one 64-byte line per LLC miss.
+template<class T>
+void benchmark_perf_counters(std::span<const T> data) {
+    using Acc = accumulator_t<T>;
+
+    std::cout << "\n=== Hardware Counter Analysis ===\n";
+    {
+        PerfRegion probe;
+        probe.stop();
+        if (!probe.failure().empty()) {
+            std::cout << "Hardware counters unavailable: " << probe.failure() << "\n";
+            return;
+        }
+    }
+    std::cout << std::left << std::setw(22) << "Method"
+              << std::setw(9) << "Threads"
+              << std::setw(11) << "Time (ms)"
+              << std::setw(12) << "Cycles (M)"
+              << std::setw(8) << "IPC"
+              << std::setw(14) << "LLC Miss (K)"
+              << std::setw(15) << "Coherence (K)"
+              << std::setw(13) << "Bytes/Cycle"
+              << std::setw(10) << "Mem GB/s" << "\n";
+    std::cout << zen::repeat("-", 114) << "\n";
+
+    auto print_row = [&](const std::string& method, unsigned int threads, auto&& func) {
+        func();
+        PerfRegion region;
+        double ms = measure_time(func);
+        auto counts = region.stop();
+        auto count_column = [](double count, double scale) {
+            std::ostringstream text;
+            if (count < 0)
+                text << "n/a";
+            else
+                text << std::fixed << std::setprecision(2) << count / scale;
+            return text.str();
+        };
+        std::cout << std::setw(22) << method
+                  << std::setw(9) << (threads > 0 ? std::to_string(threads) : "-")
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(11) << ms
+                  << std::setw(12) << count_column(counts[PerfCycles], 1e6)
+                  << std::setw(8) << count_column(counts[PerfInstructions], counts[PerfCycles])
+                  << std::setw(14) << count_column(counts[PerfLlcMisses], 1e3)
+                  << std::setw(15) << count_column(counts[PerfCoherence], 1e3)
+                  << std::setw(13) << count_column(double(data.size_bytes()), counts[PerfCycles])
+                  << std::setw(10) << count_column(counts[PerfLlcMisses] * 64.0, ms * 1e6) << "\n";
+    };
+
+    print_row("Single-Threaded", 1, [&]() {
+        Acc result;
+        single_thread_sum(data, result);
+    });
+    print_row("Async Sum", 0, [&]() { async_sum(data, 0, data.size()); });
+
+    std::vector<unsigned int> threadCounts;
+    unsigned int maxThreads = std::max<unsigned int>(std::thread::hardware_concurrency(), 1);
+    for (unsigned int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    for (unsigned int numThreads : threadCounts) {
+        for (auto order : {std::memory_order_relaxed, std::memory_order_seq_cst}) {
+            print_row(order == std::memory_order_relaxed ? "Atomic Sum (relaxed)" : "Atomic Sum (seq_cst)",
+                      numThreads, [&]() {
+                std::atomic<Acc> total(0);
+                atomic_sum(data, total, order, numThreads);
+            });
+        }
+        for (auto layout : {ReduceLayout::Naive, ReduceLayout::Padded}) {
+            print_row(layout == ReduceLayout::Naive ? "Reduce Sum" : "Reduce Sum (padded)", numThreads, [&]() {
+                std::vector<Acc> partialSums(numThreads, 0);
+                reduce_sum(data, partialSums, numThreads, layout);
+            });
+        }
+    }
+}
+
+// Streams the input through stream_sum once per chunk size; path "-" is standard input, which
+// can only be read once, so it gets a single chunk size
+template<class T>
+void benchmark_streaming(const std::string& path, const std::vector<size_t>& chunkSizes, ThreadPool& pool) {
+    std::cout << "\n=== Streaming Pipeline Analysis ===\n";
+    std::cout << std::left << std::setw(13) << "Chunk (KiB)"
+              << std::setw(10) << "Buffers"
+              << std::setw(20) << "Sum"
+              << std::setw(13) << "Total (ms)"
+              << std::setw(10) << "GB/s"
+              << std::setw(12) << "Read (ms)"
+              << std::setw(19) << "Reader Stall (ms)"
+              << std::setw(20) << "Compute Stall (ms)"
+              << std::setw(10) << "Bound" << "\n";
+    std::cout << zen::repeat("-", 127) << "\n";
+
+    for (size_t chunkBytes : chunkSizes) {
+        std::ifstream file;
+        std::istream* in = &std::cin;
+        if (path != "-") {
+            file.open(path, std::ios::binary);
+            if (!file)
+                throw std::runtime_error("cannot open " + zen::quote(path));
+            in = &file;
+        }
+
+        size_t numBuffers = pool.size() + 1;
+        StreamStats stats;
+        accumulator_t<T> total;
+        double totalTime = measure_time([&]() {
+            total = stream_sum<T>(*in, pool, chunkBytes / sizeof(T), numBuffers, SumKernel::Simd, &stats);
+        });
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(13) << chunkBytes / 1024
+                  << std::setw(10) << numBuffers
+                  << std::setw(20) << total
+                  << std::setw(13) << totalTime
+                  << std::setw(10) << stats.bytes / (totalTime * 1e6)
+                  << std::setw(12) << stats.readMs
+                  << std::setw(19) << stats.readerStallMs
+                  << std::setw(20) << stats.computeStallMs
+                  << std::setw(10) << (stats.readerStallMs > stats.computeStallMs ? "compute" : "I/O") << "\n";
+        if (path == "-")
+            break;
+    }
+}
+
+// Tables that copy the input, or write an output as large as it, only use this many elements of
+// a mapped file, which need not fit in memory
+constexpr size_t mappedCopyElements = size_t(1) << 24;
+
+// Where the benchmark input comes from: a mapped file, a stream, or generated data placed in memory
+struct InputOptions {
+    std::string filePath;       // empty: generate dataSize elements
+    std::string streamPath;     // non-empty: only run the streaming pipeline over this path, "-" is stdin
+    size_t dataSize = 100000000;
+    Placement placement = Placement::Pool;
+};
+
+template<class T>
+void run_benchmarks(const std::string& typeName, const InputOptions& input, unsigned int numThreads,
+                    ThreadPool& pool, WorkStealingPool& stealingPool, AutoTuner& tuner) {
+    if (!input.streamPath.empty()) {
+        std::cout << "Element Type: " << typeName << " (SIMD Kernel: " << simd_kernel_name<T>() << ")\n";
+        std::cout << "Input: " << (input.streamPath == "-" ? "stdin" : input.streamPath) << " (streamed)\n";
+        benchmark_streaming<T>(input.streamPath, {streamChunkBytes}, pool);
+        return;
+    }
+
+    std::optional<MappedFile> file;
+    std::optional<PlacedBuffer<T>> storage;
+    std::span<const T> data;
+    if (!input.filePath.empty()) {
+        file.emplace(input.filePath);
+        data = file->as<T>();
+        if (data.empty())
+            throw std::runtime_error(zen::quote(input.filePath) + " holds no " + typeName + " elements");
+    } else if (input.placement == Placement::Pool) {
+        pool.resize(numThreads);
+        storage.emplace(input.dataSize, pool);
+        data = storage->view();
+    } else {
+        storage.emplace(input.dataSize, input.placement, numThreads);
+        data = storage->view();
+    }
+    size_t dataSize = data.size();
+
+    std::cout << "Element Type: " << typeName << " (SIMD Kernel: " << simd_kernel_name<T>() << ")\n";
+    if (file)
+        std::cout << "Input: " << input.filePath << " (" << dataSize << " elements, mapped)\n";
+    std::span<const T> copyable = file ? data.first(std::min(dataSize, mappedCopyElements)) : data;
+    if (file)
+        std::cout << "Prefix Scan rows skipped; Thread Scaling, Incremental Sum and Encoded Input use"
+                  << " the first " << copyable.size() << " elements\n";
+    std::cout << "\n";
+
+    benchmark_basic(data, numThreads, pool, stealingPool, !file);
+
+    // Advanced benchmarks
+    benchmark_thread_scaling(copyable, pool);
+    if (perfCounters)
+        benchmark_perf_counters(data);
+    if (!file)
+        benchmark_buffer_setup<T>(dataSize, pool);
+    benchmark_workload_scaling<T>(pool, stealingPool);
+    benchmark_gpu_offload(data, pool);
+    benchmark_task_granularity(data, pool, stealingPool);
+    benchmark_scheduling(data, pool);
+    benchmark_dispatch_latency(data, pool, stealingPool);
+    benchmark_task_allocations(data, pool, stealingPool);
+    benchmark_async_throughput(data, pool);
+    benchmark_autotune(data, tuner, pool);
+    benchmark_batch(data, pool);
+    benchmark_incremental(copyable);
+    if constexpr (std::is_same_v<T, int32_t>)
+        benchmark_encoded(copyable.size(), pool);
+    benchmark_aggregate(data, pool);
+    benchmark_predicated(data, pool);
+    if constexpr (std::is_integral_v<T>)
+        benchmark_accumulator_policies(data, pool);
+    if (file)
+        benchmark_streaming<T>(input.filePath, {64 * 1024, streamChunkBytes, 16 * streamChunkBytes}, pool);
+    if constexpr (std::is_floating_point_v<T>) {
+        // The integer sequence sums exactly in double, which would hide any ordering effect,
+        // so generated runs use random values; file input is measured as it is
+        std::vector<T> randomData;
+        std::span<const T> floatData = data;
+        if (!file) {
+            randomData.resize(dataSize);
+            fill_random(randomData);
+            floatData = randomData;
+        }
+        benchmark_determinism(floatData, pool);
+        benchmark_float_accuracy(typeName, floatData, pool, stealingPool);
+    } else {
+        benchmark_determinism(data, pool);
+    }
+}
+
+// Distributed summation over TCP. Every worker node (--worker <port>) holds one shard: the
+// slice of the generated sequence the coordinator assigns it, or its own --file. The coordinator
+// (--nodes host:port,...) sends each node a job, every node sums its shard with auto_sum, and the
+// partial sums are combined with combine_tree, so the total does not depend on arrival order.
+// The total is then broadcast back, so that every node ends up with it as in an allreduce. With
+// one scalar per node there is no bandwidth for a ring or a peer-to-peer tree to save, so the
+// coordinator is the root of a one-level tree.
+//
+// Messages are a 64-bit length followed by little-endian fields, so nodes need not share a
+// byte order; partial sums travel as the 64-bit pattern of the accumulator.
+enum class NodeJob : uint64_t { Sum = 1, Done = 2 };
+
+class Message {
+public:
+    void put_u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            bytes.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+    void put_f64(double value) { put_u64(std::bit_cast<uint64_t>(value)); }
+    void put_string(const std::string& value) {
+        put_u64(value.size());
+        bytes.insert(bytes.end(), value.begin(), value.end());
+    }
+
+    uint64_t u64() {
+        need(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i)
+            value |= uint64_t(bytes[offset + i]) << (8 * i);
+        offset += 8;
+        return value;
+    }
+    double f64() { return std::bit_cast<double>(u64()); }
+    std::string string() {
+        size_t size = u64();
+        need(size);
+        std::string value(bytes.begin() + offset, bytes.begin() + offset + size);
+        offset += size;
+        return value;
+    }
+
+    std::vector<unsigned char> bytes;
+
+private:
+    void need(size_t size) const {
+        if (bytes.size() - offset < size)
+            throw std::runtime_error("truncated message from node");
+    }
+
+    size_t offset = 0;
+};
+
+template<class Acc>
+uint64_t encode_partial(Acc value) {
+    static_assert(sizeof(Acc) == sizeof(uint64_t), "partial sums travel as 64 bits");
+    return std::bit_cast<uint64_t>(value);
+}
+
+template<class Acc>
+Acc decode_partial(uint64_t bits) {
+    return std::bit_cast<Acc>(bits);
+}
+
+#if !defined(_WIN32)
+class Socket {
+public:
+    explicit Socket(int fd = -1) : fd(fd) {}
+    Socket(Socket&& other) noexcept : fd(std::exchange(other.fd, -1)) {}
+    Socket& operator=(Socket&& other) noexcept {
+        if (this != &other) {
+            close_fd();
+            fd = std::exchange(other.fd, -1);
+        }
+        return *this;
+    }
+    ~Socket() { close_fd(); }
+
+    // address is host:port
+    static Socket connect_to(const std::string& address) {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos)
+            throw std::runtime_error("node address " + zen::quote(address) + " is not host:port");
+        std::string host = address.substr(0, colon), port = address.substr(colon + 1);
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &found); rc != 0)
+            throw std::runtime_error("cannot resolve " + zen::quote(address) + ": " + gai_strerror(rc));
+        std::unique_ptr<addrinfo, decltype(&freeaddrinfo)> addresses(found, freeaddrinfo);
+
+        for (addrinfo* a = found; a; a = a->ai_next) {
+            Socket socket(::socket(a->ai_family, a->ai_socktype, a->ai_protocol));
+            if (socket.fd >= 0 && ::connect(socket.fd, a->ai_addr, a->ai_addrlen) == 0) {
+                socket.set_no_delay();
+                return socket;
+            }
+        }
+        throw std::runtime_error("cannot connect to " + zen::quote(address) + ": " + std::strerror(errno));
+    }
+
+    static Socket listen_on(uint16_t port) {
+        Socket socket(::socket(AF_INET6, SOCK_STREAM, 0));
+        if (socket.fd < 0)
+            throw std::runtime_error(std::string("cannot create socket: ") + std::strerror(errno));
+        int on = 1, off = 0;
+        setsockopt(socket.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        setsockopt(socket.fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        sockaddr_in6 address{};
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+        if (bind(socket.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(socket.fd, 4) != 0)
+            throw std::runtime_error("cannot listen on port " + std::to_string(port) + ": " + std::strerror(errno));
+        return socket;
+    }
+
+    Socket accept() const {
+        Socket client(::accept(fd, nullptr, nullptr));
+        if (client.fd < 0)
+            throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+        client.set_no_delay();
+        return client;
+    }
+
+    void send(const Message& message) const {
+        Message header;
+        header.put_u64(message.bytes.size());
+        write_all(header.bytes.data(), header.bytes.size());
+        write_all(message.bytes.data(), message.bytes.size());
+    }
+
+    Message receive() const {
+        Message header;
+        header.bytes.resize(8);
+        read_all(header.bytes.data(), header.bytes.size());
+        uint64_t size = header.u64();
+        if (size > maxMessageBytes)
+            throw std::runtime_error("oversized message from node");
+        Message message;
+        message.bytes.resize(size);
+        read_all(message.bytes.data(), size);
+        return message;
+    }
+
+    int handle() const { return fd; }
+
+private:
+    static constexpr uint64_t maxMessageBytes = 1 << 20;
+
+    void set_no_delay() const {
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+
+    void write_all(const unsigned char* data, size_t size) const {
+#ifdef MSG_NOSIGNAL
+        constexpr int flags = MSG_NOSIGNAL;
+#else
+        constexpr int flags = 0;
+#endif
+        while (size > 0) {
+            ssize_t sent = ::send(fd, data, size, flags);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent <= 0)
+                throw std::runtime_error(std::string("send to node failed: ") + std::strerror(errno));
+            data += sent;
+            size -= sent;
+        }
+    }
+
+    void read_all(unsigned char* data, size_t size) const {
+        while (size > 0) {
+            ssize_t got = ::recv(fd, data, size, 0);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got == 0)
+                throw std::runtime_error("node closed the connection");
+            if (got < 0)
+                throw std::runtime_error(std::string("receive from node failed: ") + std::strerror(errno));
+            data += got;
+            size -= got;
+        }
+    }
+
+    void close_fd() {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+
+    int fd;
+};
+
+// Receives one message from every socket, in whatever order they arrive, and passes each to
+// handle(index, message, msSinceStart)
+template<class Handle>
+void receive_from_all(const std::vector<Socket>& sockets, zen::timer& clock, Handle&& handle) {
+    std::vector<pollfd> waiting;
+    for (const Socket& socket : sockets)
+        waiting.push_back({socket.handle(), POLLIN, 0});
+    for (size_t remaining = sockets.size(); remaining > 0;) {
+        if (poll(waiting.data(), waiting.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+        }
+        for (size_t i = 0; i < waiting.size(); ++i) {
+            if (waiting[i].fd < 0 || waiting[i].revents == 0)
+                continue;
+            Message message = sockets[i].receive();
+            handle(i, message, clock.elapsed<zen::timer::usec>().count() / 1000.0);
+            waiting[i].fd = -1;
+            --remaining;
+        }
+    }
+}
+
+// Worker side of one job: loads the shard (generated shards are kept for the next job over the
+// same range), sums it, replies with the partial sum and then waits for the combined total
+template<class T>
+void serve_job(const Socket& coordinator, Message& job, const InputOptions& input, AutoTuner& tuner) {
+    using Acc = accumulator_t<T>;
+    uint64_t start = job.u64(), end = job.u64();
+
+    static std::vector<T> generated;
+    static uint64_t generatedStart = 0, generatedEnd = 0;
+    std::optional<MappedFile> file;
+    std::span<const T> shard;
+    double loadMs = measure_time([&]() {
+        if (!input.filePath.empty()) {
+            file.emplace(input.filePath);
+            shard = file->as<T>();
+        } else {
+            if (generated.size() != end - start || generatedStart != start || generatedEnd != end) {
+                generated.assign(end - start, T(0));
+                fill_sequence(std::span<T>(generated), start);
+                generatedStart = start;
+                generatedEnd = end;
+            }
+            shard = generated;
+        }
+        // Calibrate before the timed sum, not inside it
+        tuner.profile<T>();
+    });
+
+    Acc partial = 0;
+    double computeMs = measure_time([&]() { partial = auto_sum(shard, tuner); });
+
+    Message reply;
+    reply.put_u64(shard.size());
+    reply.put_f64(loadMs);
+    reply.put_f64(computeMs);
+    reply.put_u64(encode_partial(partial));
+    coordinator.send(reply);
+
+    Message total = coordinator.receive();
+    Acc value = decode_partial<Acc>(total.u64());
+    coordinator.send(Message());
+
+    std::cout << "Shard of " << shard.size() << " " << element_type_name<T>() << " elements"
+              << (input.filePath.empty() ? " [" + std::to_string(start) + ", " + std::to_string(end) + ")" : "")
+              << ": partial " << partial << ", total " << value
+              << std::fixed << std::setprecision(2) << ", compute " << computeMs << " ms" << std::endl;
+}
+
+bool serve_job_for(const std::string& typeName, const Socket& coordinator, Message& job,
+                   const InputOptions& input, AutoTuner& tuner) {
+    if (typeName == "int16")
+        serve_job<int16_t>(coordinator, job, input, tuner);
+    else if (typeName == "int32")
+        serve_job<int32_t>(coordinator, job, input, tuner);
+    else if (typeName == "uint32")
+        serve_job<uint32_t>(coordinator, job, input, tuner);
+    else if (typeName == "int64")
+        serve_job<int64_t>(coordinator, job, input, tuner);
+    else if (typeName == "float")
+        serve_job<float>(coordinator, job, input, tuner);
+    else if (typeName == "double")
+        serve_job<double>(coordinator, job, input, tuner);
+    else
+        return false;
+    return true;
+}
+
+// Serves coordinators one after another until the process is stopped
+void run_worker(uint16_t port, const InputOptions& input, AutoTuner& tuner) {
+    Socket listener = Socket::listen_on(port);
+    std::cout << "Worker listening on port " << port << std::endl;
+    while (true) {
+        Socket coordinator = listener.accept();
+        try {
+            while (true) {
+                Message job = coordinator.receive();
+                if (static_cast<NodeJob>(job.u64()) != NodeJob::Sum)
+                    break;
+                std::string typeName = job.string();
+                if (!serve_job_for(typeName, coordinator, job, input, tuner))
+                    throw std::runtime_error("unknown element type " + zen::quote(typeName));
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+        }
+    }
+}
+
+struct NodeTiming {
+    uint64_t elements = 0;
+    double loadMs = 0;
+    double computeMs = 0;
+    double commMs = 0;     // round trip of the job, less the node's own load and compute time
+};
+
+// Strong scaling over the first 1 to N nodes: the generated sequence of input.dataSize elements
+// is split evenly over the nodes in use. Workers with their own --file sum that file instead,
+// whatever the split. Every configuration runs warmupRuns times untimed first, which also
+// leaves the generated shards in place for the timed run.
+template<class T>
+void benchmark_distributed(const std::vector<std::string>& nodes, const InputOptions& input) {
+    using Acc = accumulator_t<T>;
+
+    std::vector<Socket> sockets;
+    for (const std::string& node : nodes)
+        sockets.push_back(Socket::connect_to(node));
+
+    std::cout << "=== Distributed Scaling Analysis (" << element_type_name<T>() << ", "
+              << input.dataSize << " elements) ===\n";
+    std::cout << std::left << std::setw(8) << "Nodes"
+              << std::setw(15) << "Compute (ms)"
+              << std::setw(12) << "Comm (ms)"
+              << std::setw(17) << "Allreduce (ms)"
+              << std::setw(13) << "Total (ms)"
+              << std::setw(10) << "Speedup"
+              << std::setw(12) << "Efficiency"
+              << "Sum\n";
+    std::cout << zen::repeat("-", 105) << "\n";
+
+    std::vector<NodeTiming> timings;
+    double singleNodeMs = 0;
+    for (size_t numNodes = 1; numNodes <= sockets.size(); ++numNodes) {
+        std::vector<Socket> active;
+        for (size_t i = 0; i < numNodes; ++i)
+            active.emplace_back(std::move(sockets[i]));
+
+        Acc total = 0;
+        double totalMs = 0, allreduceMs = 0;
+        for (int run = 0; run <= std::max(warmupRuns, 0); ++run) {
+            timings.assign(numNodes, NodeTiming());
+            std::vector<Acc> partials(numNodes);
+            zen::timer clock;
+            for (size_t i = 0; i < numNodes; ++i) {
+                Message job;
+                job.put_u64(static_cast<uint64_t>(NodeJob::Sum));
+                job.put_string(element_type_name<T>());
+                job.put_u64(input.dataSize * i / numNodes);
+                job.put_u64(input.dataSize * (i + 1) / numNodes);
+                active[i].send(job);
+            }
+            double slowestMs = 0;
+            receive_from_all(active, clock, [&](size_t i, Message& reply, double roundTripMs) {
+                NodeTiming& timing = timings[i];
+                timing.elements = reply.u64();
+                timing.loadMs = reply.f64();
+                timing.computeMs = reply.f64();
+                timing.commMs = std::max(roundTripMs - timing.loadMs - timing.computeMs, 0.0);
+                partials[i] = decode_partial<Acc>(reply.u64());
+                slowestMs = std::max(slowestMs, roundTripMs - timing.loadMs);
+            });
+            total = combine_tree(partials);
+
+            zen::timer broadcast;
+            Message result;
+            result.put_u64(encode_partial(total));
+            for (const Socket& socket : active)
+                socket.send(result);
+            receive_from_all(active, broadcast, [](size_t, Message&, double) {});
+            allreduceMs = broadcast.elapsed<zen::timer::usec>().count() / 1000.0;
+            totalMs = slowestMs + allreduceMs;
+        }
+
+        double computeMs = 0, commMs = 0;
+        for (const NodeTiming& timing : timings) {
+            computeMs = std::max(computeMs, timing.computeMs);
+            commMs = std::max(commMs, timing.commMs);
+        }
+        if (numNodes == 1)
+            singleNodeMs = totalMs;
+        double speedup = singleNodeMs / totalMs;
+        std::cout << std::setw(8) << numNodes
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(15) << computeMs
+                  << std::setw(12) << commMs
+                  << std::setw(17) << allreduceMs
+                  << std::setw(13) << totalMs
+                  << std::setw(10) << speedup
+                  << std::setw(12) << speedup / numNodes
+                  << total << "\n";
+
+        for (size_t i = 0; i < numNodes; ++i)
+            sockets[i] = std::move(active[i]);
+    }
+
+    std::cout << "\n=== Per-Node Breakdown (" << sockets.size() << " nodes) ===\n";
+    std::cout << std::left << std::setw(8) << "Node"
+              << std::setw(28) << "Address"
+              << std::setw(14) << "Elements"
+              << std::setw(12) << "Load (ms)"
+              << std::setw(15) << "Compute (ms)"
+              << std::setw(12) << "Comm (ms)" << "\n";
+    std::cout << zen::repeat("-", 89) << "\n";
+    for (size_t i = 0; i < timings.size(); ++i) {
+        std::cout << std::setw(8) << i
+                  << std::setw(28) << nodes[i]
+                  << std::setw(14) << timings[i].elements
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << timings[i].loadMs
+                  << std::setw(15) << timings[i].computeMs
+                  << std::setw(12) << timings[i].commMs << "\n";
+    }
+
+    Message done;
+    done.put_u64(static_cast<uint64_t>(NodeJob::Done));
+    for (const Socket& socket : sockets)
+        socket.send(done);
+}
+#else
+void run_worker(uint16_t, const InputOptions&, AutoTuner&) {
+    throw std::runtime_error("distributed mode needs POSIX sockets");
+}
+
+template<class T>
+void benchmark_distributed(const std::vector<std::string>&, const InputOptions&) {
+    throw std::runtime_error("distributed mode needs POSIX sockets");
+}
+#endif
+
+const std::vector<std::string> elementTypes = {"int16", "int32", "uint32", "int64", "float", "double"};
+
+// Runs the whole benchmark over the element type with the given name; false if the name is unknown
+bool run_benchmarks_for(const std::string& typeName, const InputOptions& input, unsigned int numThreads,
+                        ThreadPool& pool, WorkStealingPool& stealingPool, AutoTuner& tuner) {
+    if (typeName == "int16")
+        run_benchmarks<int16_t>(typeName, input, numThreads, pool, stealingPool, tuner);
+    else if (typeName == "int32")
+        run_benchmarks<int32_t>(typeName, input, numThreads, pool, stealingPool, tuner);
+    else if (typeName == "uint32")
+        run_benchmarks<uint32_t>(typeName, input, numThreads, pool, stealingPool, tuner);
+    else if (typeName == "int64")
+        run_benchmarks<int64_t>(typeName, input, numThreads, pool, stealingPool, tuner);
+    else if (typeName == "float")
+        run_benchmarks<float>(typeName, input, numThreads, pool, stealingPool, tuner);
+    else if (typeName == "double")
+        run_benchmarks<double>(typeName, input, numThreads, pool, stealingPool, tuner);
+    else
+        return false;
+    return true;
+}
+
+// Runs the distributed benchmark over the element type with the given name; false if the name is unknown
+bool run_distributed_for(const std::string& typeName, const std::vector<std::string>& nodes,
+                         const InputOptions& input) {
+    if (typeName == "int16")
+        benchmark_distributed<int16_t>(nodes, input);
+    else if (typeName == "int32")
+        benchmark_distributed<int32_t>(nodes, input);
+    else if (typeName == "uint32")
+        benchmark_distributed<uint32_t>(nodes, input);
+    else if (typeName == "int64")
+        benchmark_distributed<int64_t>(nodes, input);
+    else if (typeName == "float")
+        benchmark_distributed<float>(nodes, input);
+    else if (typeName == "double")
+        benchmark_distributed<double>(nodes, input);
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    zen::cmd_args args(argv, argc);
+    InputOptions input;
+    if (args.is_present("--n")) {
+        auto n = std::stoi(args.get_options("--n")[0]);
+        if (n > 0)
+            input.dataSize = n;
+    }
+    if (args.is_present("--file")) {
+        auto options = args.get_options("--file");
+        if (options.empty()) {
+            std::cerr << "--file expects a path\n";
+            return 1;
+        }
+        input.filePath = options[0];
+    }
+    if (args.is_present("--stream")) {
+        // Without a path, stream standard input
+        auto options = args.get_options("--stream");
+        input.streamPath = options.empty() ? "-" : options[0];
+    }
+
+    std::vector<std::string> types = {"int32"};
+    if (args.is_present("--type")) {
+        auto options = args.get_options("--type");
+        if (!options.empty())
+            types = options[0] == "all" ? elementTypes : options;
+    }
+    for (const auto& type : types) {
+        if (std::find(elementTypes.begin(), elementTypes.end(), type) == elementTypes.end()) {
+            std::cerr << "Unknown --type " << zen::quote(type) << ", expected one of: all";
+            for (const auto& name : elementTypes)
+                std::cerr << ", " << name;
+            std::cerr << "\n";
+            return 1;
+        }
+    }
+
+    if (input.streamPath == "-") {
+        if (types.size() > 1) {
+            std::cerr << "--stream without a path reads standard input once and takes a single --type\n";
+            return 1;
+        }
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    }
+
+    pinThreads = args.is_present("--pin");
+
+    perfCounters = args.is_present("--perf");
+    if (args.is_present("--perf-coherence")) {
+        auto options = args.get_options("--perf-coherence");
+        if (!options.empty()) {
+            auto event = parse_number<uint64_t>(options[0], 0);
+            if (!event) {
+                std::cerr << "--perf-coherence expects a raw event code\n";
+                return 1;
+            }
+            perfCounters = true;
+            perfCoherenceEvent = *event;
+        }
+    }
+
+    if (args.is_present("--stats")) {
+        auto options = args.get_options("--stats");
+        try {
+            aggregateStats = parse_stats(options.empty() ? "" : options[0]);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (args.is_present("--warmup")) {
+        auto options = args.get_options("--warmup");
+        if (!options.empty()) {
+            auto runs = parse_number<int>(options[0]);
+            if (!runs) {
+                std::cerr << "--warmup expects a number of runs\n";
+                return 1;
+            }
+            warmupRuns = std::max(*runs, 0);
+        }
+    }
+    if (args.is_present("--reps")) {
+        auto options = args.get_options("--reps");
+        if (!options.empty()) {
+            auto runs = parse_number<int>(options[0]);
+            if (!runs) {
+                std::cerr << "--reps expects a number of runs\n";
+                return 1;
+            }
+            timedRuns = std::max(*runs, 1);
+        }
+    }
+
+    // Calibrated profile to reuse, written back after the run
+    std::string tuneProfile;
+    if (args.is_present("--tune-profile")) {
+        auto options = args.get_options("--tune-profile");
+        if (options.empty()) {
+            std::cerr << "--tune-profile expects a path\n";
+            return 1;
+        }
+        tuneProfile = options[0];
+    }
+
+    // Machine-readable records, and the baseline to compare them against
+    std::string format, outputPath, comparePath;
+    double threshold = 5.0;
+    if (args.is_present("--format")) {
+        auto options = args.get_options("--format");
+        format = options.empty() ? "" : options[0];
+        if (format != "json" && format != "csv") {
+            std::cerr << "Unknown --format " << zen::quote(format) << ", expected one of: json, csv\n";
+            return 1;
+        }
+    }
+    if (args.is_present("--output")) {
+        auto options = args.get_options("--output");
+        if (options.empty()) {
+            std::cerr << "--output expects a path\n";
+            return 1;
+        }
+        outputPath = options[0];
+    }
+    if (args.is_present("--threshold")) {
+        auto options = args.get_options("--threshold");
+        if (!options.empty()) {
+            auto percent = parse_number<double>(options[0]);
+            if (!percent) {
+                std::cerr << "--threshold expects a percentage\n";
+                return 1;
+            }
+            threshold = *percent;
+        }
+    }
+    std::vector<BenchmarkRecord> baseline;
+    if (args.is_present("--compare")) {
+        auto options = args.get_options("--compare");
+        if (options.empty()) {
+            std::cerr << "--compare expects a baseline file\n";
+            return 1;
+        }
+        comparePath = options[0];
+        try {
+            baseline = load_records(comparePath);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    recordResults = !format.empty() || !comparePath.empty();
+
+    // Chrome trace of the worker timelines
+    std::string tracePath;
+    if (args.is_present("--trace")) {
+        auto options = args.get_options("--trace");
+        if (options.empty()) {
+            std::cerr << "--trace expects a path\n";
+            return 1;
+        }
+        tracePath = options[0];
+    }
+    StdoutRedirect redirect(!format.empty() && outputPath.empty());
+
+    Placement& placement = input.placement;
+    if (args.is_present("--placement")) {
+        auto options = args.get_options("--placement");
+        std::string name = options.empty() ? "" : options[0];
+        if (name == "serial")
+            placement = Placement::Serial;
+        else if (name == "local")
+            placement = Placement::Local;
+        else if (name == "interleaved")
+            placement = Placement::Interleaved;
+        else if (name != "pool") {
+            std::cerr << "Unknown --placement " << zen::quote(name)
+                      << ", expected one of: pool, serial, local, interleaved\n";
+            return 1;
+        }
+    }
+    if (args.is_present("--huge-pages")) {
+        auto options = args.get_options("--huge-pages");
+        std::string name = options.empty() ? "" : options[0];
+        if (name == "off")
+            hugePages = HugePages::Off;
+        else if (name == "explicit")
+            hugePages = HugePages::Explicit;
+        else if (name != "transparent") {
+            std::cerr << "Unknown --huge-pages " << zen::quote(name)
+                      << ", expected one of: off, transparent, explicit\n";
+            return 1;
+        }
+    }
+
+    // Distributed mode: serve as a worker node, or coordinate the listed nodes
+    int workerPort = 0;
+    if (args.is_present("--worker")) {
+        auto options = args.get_options("--worker");
+        workerPort = options.empty() ? 0 : parse_number<int>(options[0]).value_or(0);
+        if (workerPort <= 0 || workerPort > 65535) {
+            std::cerr << "--worker expects a port number\n";
+            return 1;
+        }
+    }
+    std::vector<std::string> nodes;
+    if (args.is_present("--nodes")) {
+        for (const std::string& option : args.get_options("--nodes")) {
+            std::stringstream list(option);
+            for (std::string node; std::getline(list, node, ',');)
+                if (!node.empty())
+                    nodes.push_back(node);
+        }
+        if (nodes.empty()) {
+            std::cerr << "--nodes expects a comma-separated list of host:port\n";
+            return 1;
+        }
+    }
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 2;
+
+    std::cout << "Thread Count: " << numThreads << "\n";
+    std::cout << "NUMA Nodes: " << cpu_topology().nodes.size()
+              << ", Pinning: " << (pinThreads ? "on" : "off")
+              << ", Placement: " << to_string(placement)
+              << ", Huge Pages: " << to_string(hugePages) << "\n";
+    std::cout << "SIMD Kernel: " << simd_kernel().name << "\n\n";
+
+    // Long-lived pools shared by every ThreadPool benchmark
+    ThreadPool pool(numThreads);
+    WorkStealingPool stealingPool(numThreads);
+    AutoTuner tuner(pool, stealingPool);
+    if (!tuneProfile.empty() && tuner.load(tuneProfile))
+        std::cout << "Autotuner Profile: " << tuneProfile << " (loaded)\n\n";
+
+    if (workerPort > 0) {
+        try {
+            run_worker(static_cast<uint16_t>(workerPort), input, tuner);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    for (size_t i = 0; i < types.size(); ++i) {
+        if (i > 0)
+            std::cout << "\n";
+        try {
+            if (!nodes.empty())
+                run_distributed_for(types[i], nodes, input);
+            else
+                run_benchmarks_for(types[i], input, numThreads, pool, stealingPool, tuner);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (!tuneProfile.empty()) {
+        try {
+            tuner.save(tuneProfile);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (!format.empty()) {
+        std::ofstream file;
+        std::ostream stdoutStream(redirect.stdout_buffer());
+        std::ostream* out = &stdoutStream;
+        if (!outputPath.empty()) {
+            file.open(outputPath);
+            if (!file) {
+                std::cerr << "Error: cannot write " << zen::quote(outputPath) << "\n";
+                return 1;
+            }
+            out = &file;
+        }
+        HostInfo host = host_info();
+        if (format == "json")
+            write_records_json(*out, host, benchmarkRecords);
+        else
+            write_records_csv(*out, host, benchmarkRecords);
+    }
+
+    if (!tracePath.empty()) {
+        std::ofstream file(tracePath);
+        if (!file) {
+            std::cerr << "Error: cannot write " << zen::quote(tracePath) << "\n";
+            return 1;
+        }
+        worker_trace().write_chrome_trace(file);
+    }
+
+    // A regression fails the run with status 2, so that it can gate a CI job
+    if (!comparePath.empty() && compare_records(baseline, benchmarkRecords, threshold) > 0)
+        return 2;
 
     return 0;
 }